@@ -0,0 +1,67 @@
+"""
+Builds the thesisdsp extension module over the JUCE-free core in
+../Source; it needs nothing but a C++17 compiler and Python's headers.
+The core is built first as the static library thesiscore (the same
+sources as CMake's ThesisCore) and the module links it.
+
+    cd Python && python setup.py build_ext --inplace
+"""
+
+import os
+from setuptools import setup, Extension
+from setuptools.command.build_clib import build_clib
+from setuptools.command.build_ext import build_ext
+
+source = os.path.join("..", "Source")
+
+core = [
+    "BandMeters.cpp", "BankKernels.cpp", "BankKernelsAVX2.cpp", "BankKernelsAVX512.cpp",
+    "BankResponse.cpp", "CpuGovernor.cpp", "HarmonicBank.cpp", "ModBank.cpp",
+    "Modulator.cpp", "MultiStreamBank.cpp", "OctaveAnalyzer.cpp", "OfflineRenderer.cpp",
+    "Oversampler.cpp", "PartialMap.cpp", "SharedTables.cpp", "ThesisDSP.cpp", "WorkerPool.cpp",
+]
+
+flags = ["-std=c++17", "-O3"]
+
+thesiscore = (
+    "thesiscore",
+    {
+        "sources": [os.path.join(source, name) for name in core],
+        "include_dirs": [source],
+        "cflags": flags,
+    },
+)
+
+
+
+class BuildClib(build_clib):
+    # the objects of ../Source/*.cpp land in build_temp/../Source, which
+    # only resolves once build_temp itself exists
+    def run(self):
+        self.mkpath(self.build_temp)
+        super().run()
+
+
+class BuildExt(build_ext):
+    # build_ext only links the libraries; build them first so that
+    # build_ext --inplace works on its own
+    def run(self):
+        self.run_command("build_clib")
+        super().run()
+
+
+setup(
+    name="thesisdsp",
+    version="1.0.0",
+    libraries=[thesiscore],
+    ext_modules=[
+        Extension(
+            "thesisdsp",
+            sources=["thesisdsp.cpp"],
+            include_dirs=[source],
+            language="c++",
+            extra_compile_args=flags,
+        )
+    ],
+    cmdclass={"build_clib": BuildClib, "build_ext": BuildExt},
+)
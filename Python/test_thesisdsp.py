@@ -0,0 +1,132 @@
+"""
+Tests for the thesisdsp module; they need NumPy and the module built in
+place first:
+
+    cd Python && python setup.py build_ext --inplace
+    python -m unittest test_thesisdsp
+"""
+
+import threading
+import time
+import unittest
+
+import numpy as np
+
+import thesisdsp
+
+RATE = 48000
+PARAMS = {"Q": 40, "Quality": 1, "Center Frequency": 110, "Mod Freq": 1, "Oversampling": 1}
+
+
+def noise(shape, seed=1):
+    return np.random.default_rng(seed).uniform(-0.5, 0.5, shape).astype(np.float32)
+
+
+class TestBank(unittest.TestCase):
+    def test_float64_matches_float32(self):
+        audio = noise((2, 4 * 1024 + 37))
+        single = audio.copy()
+        double = audio.astype(np.float64)
+
+        thesisdsp.Bank(RATE, params=PARAMS).process(single)
+        thesisdsp.Bank(RATE, params=PARAMS).process(double)
+
+        self.assertEqual(double.dtype, np.float64)
+        np.testing.assert_array_equal(double, single.astype(np.float64))
+
+    def test_processes_in_place(self):
+        audio = noise((2, 2048))
+        before = audio.copy()
+        pointer = audio.ctypes.data
+
+        self.assertIsNone(thesisdsp.Bank(RATE, params=PARAMS).process(audio))
+
+        self.assertEqual(audio.ctypes.data, pointer)
+        self.assertFalse(np.array_equal(audio, before))
+        self.assertTrue(np.all(np.isfinite(audio)))
+
+    def test_processes_a_view_in_place(self):
+        # channels any distance apart: every other row of a larger array
+        rows = noise((4, 2048))
+        expected = rows[::2].copy()
+
+        thesisdsp.Bank(RATE, params=PARAMS).process(rows[::2])
+        thesisdsp.Bank(RATE, params=PARAMS).process(expected)
+
+        np.testing.assert_array_equal(rows[::2], expected)
+        np.testing.assert_array_equal(rows[1::2], noise((4, 2048))[1::2])
+
+    def test_unknown_ids_raise_key_error(self):
+        with self.assertRaises(KeyError):
+            thesisdsp.Bank(RATE, params={"No Such Parameter": 1})
+
+        bank = thesisdsp.Bank(RATE)
+
+        with self.assertRaises(KeyError):
+            bank.set_params({"No Such Parameter": 1})
+
+        audio = noise((2, 256))
+
+        with self.assertRaises(KeyError):
+            thesisdsp.render_batch(audio, np.empty((1,) + audio.shape, np.float32),
+                                   [{"No Such Parameter": 1}], RATE)
+
+    def test_processing_releases_the_gil(self):
+        # Python on this thread keeps running while the bank is inside
+        # process; with the GIL held, nothing would land in the middle of it
+        audio = noise((2, 10 * RATE))
+        bank = thesisdsp.Bank(RATE, params=dict(PARAMS, Quality=2))
+        span = []
+
+        def run():
+            span.append(time.perf_counter())
+            bank.process(audio)
+            span.append(time.perf_counter())
+
+        worker = threading.Thread(target=run)
+        ticks = []
+
+        worker.start()
+        while worker.is_alive():
+            ticks.append(time.perf_counter())
+        worker.join()
+
+        start, end = span
+        middle = [t for t in ticks if start + 0.25 * (end - start) < t < end - 0.25 * (end - start)]
+        self.assertTrue(middle)
+
+
+class TestRenderBatch(unittest.TestCase):
+    SETS = [dict(PARAMS, Q=q, Curve=c) for q in (10, 40) for c in (0.5, 2)]
+
+    def render_separately(self, audio, offline):
+        expected = np.empty((len(self.SETS),) + audio.shape, audio.dtype)
+
+        for i, params in enumerate(self.SETS):
+            expected[i] = audio
+            bank = thesisdsp.Bank(RATE, channels=audio.shape[0], params=params, offline=offline)
+            bank.process(expected[i])
+
+        return expected
+
+    def test_matches_separate_banks(self):
+        audio = noise((2, 3000))
+        output = np.empty((len(self.SETS),) + audio.shape, np.float32)
+
+        thesisdsp.render_batch(audio, output, self.SETS, RATE, threads=3)
+
+        np.testing.assert_array_equal(output, self.render_separately(audio, False))
+
+    def test_offline_matches_separate_banks(self):
+        # a batch renders each offline bank on its one thread, which sums
+        # the bands the same as a bank on every core
+        audio = noise((2, 3000))
+        output = np.empty((len(self.SETS),) + audio.shape, np.float32)
+
+        thesisdsp.render_batch(audio, output, self.SETS, RATE, offline=True, threads=2)
+
+        np.testing.assert_array_equal(output, self.render_separately(audio, True))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,662 @@
+/*
+  ==============================================================================
+
+    thesisdsp.cpp
+    Created: 25 Oct 2026 9:41:06am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+/*
+    Python module over the C interface in ThesisDSP.h, for generating
+    datasets from scripts rather than through a plugin host:
+
+        import numpy as np, thesisdsp
+
+        bank = thesisdsp.Bank(48000, channels=2, params={"Q": 40, "Quality": 2})
+        bank.process(audio)     # (channels, samples) or (samples,), in place
+
+        out = np.empty((len(sets),) + audio.shape, np.float32)
+        thesisdsp.render_batch(audio, out, sets, 48000)
+
+        thesisdsp.process_streams(stems, 48000, {"Q": 40})    # (streams, channels, samples)
+
+    Arrays come in through the buffer protocol, so NumPy buffers are
+    processed where they are and the module needs nothing beyond Python to
+    build. float32 runs straight on the array's memory; float64 goes through
+    a block of float scratch at a time. Samples must be contiguous within a
+    channel; channels may be any distance apart.
+
+    Parameter dicts are keyed by the plugin's parameter IDs and take the
+    same values, choices by index. Processing releases the GIL, so banks on
+    different threads run in parallel; render_batch spreads its parameter
+    sets over a WorkerPool itself.
+*/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "ThesisDSP.h"
+#include "HarmonicBank.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+typedef std::vector<std::pair<ThesisParam, float>> ParamList;
+
+//==============================================================================
+// a float32 or float64 buffer of [items,] [channels,] samples
+struct AudioBuffer
+{
+    Py_buffer view {};
+    bool isDouble {false};
+    int numItems {1};
+    int numChans {1};
+    int numSamples {0};
+    Py_ssize_t itemStride {0};
+    Py_ssize_t chanStride {0};
+
+    ~AudioBuffer()
+    {
+        if (view.obj != nullptr)
+            PyBuffer_Release(&view);
+    }
+
+    char* row(int item, int chan) const
+    {
+        return static_cast<char*>(view.buf) + item * itemStride + chan * chanStride;
+    }
+};
+
+static bool isFormat(const char* format, char type)
+{
+    if (format == nullptr)
+        return type == 'B';
+
+    if (*format == '@' || *format == '=')
+        format++;
+   #if PY_LITTLE_ENDIAN
+    else if (*format == '<')
+        format++;
+   #endif
+
+    return format[0] == type && format[1] == '\0';
+}
+
+// batched buffers have a leading dimension of items; sets a Python error
+// and returns false if the object will not do
+static bool getAudio(PyObject* object, AudioBuffer& audio, bool writable, bool batched)
+{
+    if (PyObject_GetBuffer(object, &audio.view, writable ? PyBUF_RECORDS : PyBUF_RECORDS_RO) != 0)
+        return false;
+
+    const Py_buffer& view = audio.view;
+    const int leading = batched ? 1 : 0;
+
+    if (isFormat(view.format, 'f'))
+        audio.isDouble = false;
+    else if (isFormat(view.format, 'd'))
+        audio.isDouble = true;
+    else
+    {
+        PyErr_SetString(PyExc_TypeError, "audio must be float32 or float64");
+        return false;
+    }
+
+    if (view.ndim != leading + 1 && view.ndim != leading + 2)
+    {
+        PyErr_Format(PyExc_ValueError, "audio must have %d or %d dimensions", leading + 1, leading + 2);
+        return false;
+    }
+
+    const int last = view.ndim - 1;
+
+    if (view.shape[last] > 1 && view.strides[last] != view.itemsize)
+    {
+        PyErr_SetString(PyExc_ValueError, "samples must be contiguous within each channel");
+        return false;
+    }
+
+    if (view.shape[last] > INT_MAX || (batched && view.shape[0] > INT_MAX))
+    {
+        PyErr_SetString(PyExc_ValueError, "audio is too long");
+        return false;
+    }
+
+    audio.numItems = batched ? int(view.shape[0]) : 1;
+    audio.itemStride = batched ? view.strides[0] : 0;
+    audio.numChans = view.ndim == leading + 2 ? int(view.shape[leading]) : 1;
+    audio.chanStride = view.ndim == leading + 2 ? view.strides[leading] : 0;
+    audio.numSamples = int(view.shape[last]);
+
+    if (audio.numChans < 1 || audio.numChans > MAX_CHANNELS)
+    {
+        PyErr_Format(PyExc_ValueError, "audio must have 1 to %d channels", MAX_CHANNELS);
+        return false;
+    }
+
+    return true;
+}
+
+template <typename From, typename To>
+static void convertSamples(const char* from, char* to, int numSamples)
+{
+    const From* source = reinterpret_cast<const From*>(from);
+    To* dest = reinterpret_cast<To*>(to);
+
+    for (int i = 0; i < numSamples; i++)
+        dest[i] = To(source[i]);
+}
+
+static void copySamples(const char* from, bool fromDouble, char* to, bool toDouble, int numSamples)
+{
+    if (fromDouble == toDouble)
+        std::memmove(to, from, size_t(numSamples) * (toDouble ? sizeof(double) : sizeof(float)));
+    else if (fromDouble)
+        convertSamples<double, float>(from, to, numSamples);
+    else
+        convertSamples<float, double>(from, to, numSamples);
+}
+
+// runs one item of audio through the bank in place; float64 goes through
+// scratch, which holds MAX_CHANNELS blocks of blockSize
+static void processAudio(ThesisBank* bank, const AudioBuffer& audio, int item, int blockSize, float* scratch)
+{
+    float* channels[MAX_CHANNELS];
+
+    if (! audio.isDouble)
+    {
+        for (int chan = 0; chan < audio.numChans; chan++)
+            channels[chan] = reinterpret_cast<float*>(audio.row(item, chan));
+
+        thesis_process(bank, channels, audio.numChans, audio.numSamples);
+        return;
+    }
+
+    for (int chan = 0; chan < audio.numChans; chan++)
+        channels[chan] = scratch + chan * blockSize;
+
+    for (int start = 0; start < audio.numSamples; start += blockSize)
+    {
+        const int numSamples = std::min(blockSize, audio.numSamples - start);
+
+        for (int chan = 0; chan < audio.numChans; chan++)
+            copySamples(audio.row(item, chan) + start * Py_ssize_t(sizeof(double)), true,
+                        reinterpret_cast<char*>(channels[chan]), false, numSamples);
+
+        thesis_process(bank, channels, audio.numChans, numSamples);
+
+        for (int chan = 0; chan < audio.numChans; chan++)
+            copySamples(reinterpret_cast<const char*>(channels[chan]), false,
+                        audio.row(item, chan) + start * Py_ssize_t(sizeof(double)), true, numSamples);
+    }
+}
+
+// reads a dict of parameter ID to value; sets a Python error and returns
+// false on an unknown ID or a value that is not a number
+static bool parseParams(PyObject* dict, ParamList& params)
+{
+    if (dict == nullptr || dict == Py_None)
+        return true;
+
+    if (! PyDict_Check(dict))
+    {
+        PyErr_SetString(PyExc_TypeError, "parameters must be a dict of parameter ID to value");
+        return false;
+    }
+
+    PyObject* key;
+    PyObject* value;
+    Py_ssize_t pos = 0;
+
+    while (PyDict_Next(dict, &pos, &key, &value))
+    {
+        const char* id = PyUnicode_Check(key) ? PyUnicode_AsUTF8(key) : nullptr;
+
+        if (id == nullptr)
+        {
+            if (! PyErr_Occurred())
+                PyErr_SetString(PyExc_TypeError, "parameter IDs must be strings");
+            return false;
+        }
+
+        const int param = thesis_find_param(id);
+
+        if (param < 0)
+        {
+            PyErr_Format(PyExc_KeyError, "no parameter '%s'", id);
+            return false;
+        }
+
+        const double number = PyFloat_AsDouble(value);
+
+        if (number == -1.0 && PyErr_Occurred())
+            return false;
+
+        params.emplace_back(ThesisParam(param), float(number));
+    }
+
+    return true;
+}
+
+static void applyParams(ThesisBank* bank, const ParamList& params)
+{
+    for (const auto& param : params)
+        thesis_set_param(bank, param.first, param.second);
+}
+
+//==============================================================================
+struct BankObject
+{
+    PyObject_HEAD
+    ThesisBank* bank;
+    float* scratch;
+    int blockSize;
+    int numChannels;
+    bool busy;
+};
+
+static void Bank_dealloc(BankObject* self)
+{
+    thesis_destroy(self->bank);
+    delete[] self->scratch;
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static int Bank_init(BankObject* self, PyObject* args, PyObject* kwargs)
+{
+    static const char* keywords[] = { "sample_rate", "max_block_size", "channels", "params", "offline", nullptr };
+
+    double sampleRate;
+    int blockSize = 512, numChannels = 2, offline = 0;
+    PyObject* dict = nullptr;
+
+    if (! PyArg_ParseTupleAndKeywords(args, kwargs, "d|iiOp", const_cast<char**>(keywords),
+                                      &sampleRate, &blockSize, &numChannels, &dict, &offline))
+        return -1;
+
+    if (sampleRate <= 0 || blockSize <= 0 || numChannels < 1 || numChannels > MAX_CHANNELS)
+    {
+        PyErr_Format(PyExc_ValueError, "needs a positive sample rate and block size and 1 to %d channels", MAX_CHANNELS);
+        return -1;
+    }
+
+    ParamList params;
+
+    if (! parseParams(dict, params))
+        return -1;
+
+    if (self->bank != nullptr)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the bank is already initialised");
+        return -1;
+    }
+
+    self->bank = thesis_create();
+    self->scratch = new (std::nothrow) float[size_t(MAX_CHANNELS) * size_t(blockSize)];
+
+    if (self->bank == nullptr || self->scratch == nullptr)
+    {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    self->blockSize = blockSize;
+    self->numChannels = numChannels;
+
+    applyParams(self->bank, params);
+    thesis_set_offline(self->bank, offline);
+    thesis_prepare(self->bank, sampleRate, blockSize, numChannels);
+
+    return 0;
+}
+
+static bool checkBank(BankObject* self)
+{
+    if (self->bank == nullptr)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the bank is not initialised");
+        return false;
+    }
+
+    if (self->busy)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "the bank is processing on another thread");
+        return false;
+    }
+
+    return true;
+}
+
+static PyObject* Bank_process(BankObject* self, PyObject* object)
+{
+    if (! checkBank(self))
+        return nullptr;
+
+    AudioBuffer audio;
+
+    if (! getAudio(object, audio, true, false))
+        return nullptr;
+
+    if (audio.numChans != self->numChannels)
+    {
+        PyErr_Format(PyExc_ValueError, "the bank was made for %d channels, not %d", self->numChannels, audio.numChans);
+        return nullptr;
+    }
+
+    // the flag is only touched with the GIL held
+    self->busy = true;
+
+    Py_BEGIN_ALLOW_THREADS
+    processAudio(self->bank, audio, 0, self->blockSize, self->scratch);
+    Py_END_ALLOW_THREADS
+
+    self->busy = false;
+
+    Py_RETURN_NONE;
+}
+
+static PyObject* Bank_set_params(BankObject* self, PyObject* dict)
+{
+    if (! checkBank(self))
+        return nullptr;
+
+    ParamList params;
+
+    if (! parseParams(dict, params))
+        return nullptr;
+
+    applyParams(self->bank, params);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject* Bank_latency(BankObject* self, PyObject*)
+{
+    if (! checkBank(self))
+        return nullptr;
+
+    return PyLong_FromLong(thesis_get_latency(self->bank));
+}
+
+static PyMethodDef Bank_methods[] = {
+    { "process", reinterpret_cast<PyCFunction>(Bank_process), METH_O,
+      "process(audio)\n--\n\nFilters a float32 or float64 array of (channels, samples) or (samples,) in place." },
+    { "set_params", reinterpret_cast<PyCFunction>(Bank_set_params), METH_O,
+      "set_params(params)\n--\n\nSets parameters from a dict keyed by the plugin's parameter IDs, from the next block." },
+    { "latency", reinterpret_cast<PyCFunction>(Bank_latency), METH_NOARGS,
+      "latency()\n--\n\nSamples the output trails the input by at the current parameters." },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+static PyTypeObject BankType = { PyVarObject_HEAD_INIT(nullptr, 0) };
+
+//==============================================================================
+struct BatchRender
+{
+    const AudioBuffer* input;
+    const AudioBuffer* output;
+    const std::vector<ParamList>* paramSets;
+    double sampleRate;
+    int blockSize;
+    bool offline;
+    std::atomic<int> failures {0};
+};
+
+static void renderOne(void* context, int index)
+{
+    BatchRender& render = *static_cast<BatchRender*>(context);
+    const AudioBuffer& input = *render.input;
+    const AudioBuffer& output = *render.output;
+
+    ThesisBank* bank = thesis_create();
+
+    if (bank == nullptr)
+    {
+        render.failures++;
+        return;
+    }
+
+    applyParams(bank, (*render.paramSets)[size_t(index)]);
+
+    // the batch already runs a bank per thread; offline banks spreading
+    // their bands over every core on top of that would only fight for them
+    thesis_set_offline_threads(bank, 1);
+    thesis_set_offline(bank, render.offline ? 1 : 0);
+    thesis_prepare(bank, render.sampleRate, render.blockSize, input.numChans);
+
+    for (int chan = 0; chan < input.numChans; chan++)
+        copySamples(input.row(0, chan), input.isDouble, output.row(index, chan), output.isDouble, input.numSamples);
+
+    std::vector<float> scratch;
+
+    if (output.isDouble)
+        scratch.resize(size_t(MAX_CHANNELS) * size_t(render.blockSize));
+
+    processAudio(bank, output, index, render.blockSize, scratch.data());
+
+    thesis_destroy(bank);
+}
+
+static PyObject* render_batch(PyObject*, PyObject* args, PyObject* kwargs)
+{
+    static const char* keywords[] = { "input", "output", "param_sets", "sample_rate",
+                                       "max_block_size", "offline", "threads", nullptr };
+
+    PyObject* inputObject;
+    PyObject* outputObject;
+    PyObject* setsObject;
+    double sampleRate;
+    int blockSize = 512, offline = 0, numThreads = 0;
+
+    if (! PyArg_ParseTupleAndKeywords(args, kwargs, "OOOd|ipi", const_cast<char**>(keywords),
+                                      &inputObject, &outputObject, &setsObject, &sampleRate,
+                                      &blockSize, &offline, &numThreads))
+        return nullptr;
+
+    if (sampleRate <= 0 || blockSize <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "needs a positive sample rate and block size");
+        return nullptr;
+    }
+
+    AudioBuffer input, output;
+
+    if (! getAudio(inputObject, input, false, false) || ! getAudio(outputObject, output, true, true))
+        return nullptr;
+
+    std::vector<ParamList> paramSets;
+
+    {
+        PyObject* sets = PySequence_Fast(setsObject, "param_sets must be a sequence of dicts");
+
+        if (sets == nullptr)
+            return nullptr;
+
+        const Py_ssize_t numSets = PySequence_Fast_GET_SIZE(sets);
+        paramSets.resize(size_t(numSets));
+
+        for (Py_ssize_t i = 0; i < numSets; i++)
+        {
+            if (! parseParams(PySequence_Fast_GET_ITEM(sets, i), paramSets[size_t(i)]))
+            {
+                Py_DECREF(sets);
+                return nullptr;
+            }
+        }
+
+        Py_DECREF(sets);
+    }
+
+    if (size_t(output.numItems) != paramSets.size()
+         || output.numChans != input.numChans || output.numSamples != input.numSamples
+         || output.view.ndim != input.view.ndim + 1)
+    {
+        PyErr_SetString(PyExc_ValueError, "output must be (len(param_sets),) + input.shape");
+        return nullptr;
+    }
+
+    if (paramSets.empty())
+        Py_RETURN_NONE;
+
+    if (numThreads <= 0)
+        numThreads = int(std::max(std::thread::hardware_concurrency(), 1u));
+
+    BatchRender render;
+    render.input = &input;
+    render.output = &output;
+    render.paramSets = &paramSets;
+    render.sampleRate = sampleRate;
+    render.blockSize = blockSize;
+    render.offline = offline != 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    WorkerPool pool;
+    pool.start(std::min(numThreads, output.numItems) - 1);
+    pool.run(renderOne, &render, output.numItems);
+    pool.stop();
+    Py_END_ALLOW_THREADS
+
+    if (render.failures > 0)
+        return PyErr_NoMemory();
+
+    Py_RETURN_NONE;
+}
+
+//==============================================================================
+static PyObject* process_streams(PyObject*, PyObject* args, PyObject* kwargs)
+{
+    static const char* keywords[] = { "audio", "sample_rate", "params", "max_block_size", "threads", nullptr };
+
+    PyObject* audioObject;
+    PyObject* dict = nullptr;
+    double sampleRate;
+    int blockSize = 512, numThreads = 1;
+
+    if (! PyArg_ParseTupleAndKeywords(args, kwargs, "Od|Oii", const_cast<char**>(keywords),
+                                      &audioObject, &sampleRate, &dict, &blockSize, &numThreads))
+        return nullptr;
+
+    if (sampleRate <= 0 || blockSize <= 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "needs a positive sample rate and block size");
+        return nullptr;
+    }
+
+    AudioBuffer audio;
+    ParamList params;
+
+    if (! getAudio(audioObject, audio, true, true) || ! parseParams(dict, params))
+        return nullptr;
+
+    if (audio.numItems == 0 || audio.numSamples == 0)
+        Py_RETURN_NONE;
+
+    if (numThreads <= 0)
+        numThreads = int(std::max(std::thread::hardware_concurrency(), 1u));
+
+    ThesisStreams* streams = thesis_streams_create();
+
+    if (streams == nullptr)
+        return PyErr_NoMemory();
+
+    for (const auto& param : params)
+        thesis_streams_set_param(streams, param.first, param.second);
+
+    // float64 runs on a float copy of the whole batch
+    const int numSignals = audio.numItems * audio.numChans;
+    std::vector<float*> channels(static_cast<size_t>(numSignals));
+    std::vector<float> converted;
+
+    if (audio.isDouble)
+        converted.resize(size_t(numSignals) * size_t(audio.numSamples));
+
+    for (int i = 0; i < numSignals; i++)
+    {
+        char* row = audio.row(i / audio.numChans, i % audio.numChans);
+
+        if (! audio.isDouble)
+        {
+            channels[size_t(i)] = reinterpret_cast<float*>(row);
+            continue;
+        }
+
+        channels[size_t(i)] = converted.data() + size_t(i) * size_t(audio.numSamples);
+        copySamples(row, true, reinterpret_cast<char*>(channels[size_t(i)]), false, audio.numSamples);
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    thesis_streams_prepare(streams, sampleRate, blockSize, audio.numItems, audio.numChans, numThreads);
+    thesis_streams_process(streams, channels.data(), audio.numSamples);
+    Py_END_ALLOW_THREADS
+
+    if (audio.isDouble)
+        for (int i = 0; i < numSignals; i++)
+            copySamples(reinterpret_cast<const char*>(channels[size_t(i)]), false,
+                        audio.row(i / audio.numChans, i % audio.numChans), true, audio.numSamples);
+
+    thesis_streams_destroy(streams);
+
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef module_methods[] = {
+    { "render_batch", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(render_batch)), METH_VARARGS | METH_KEYWORDS,
+      "render_batch(input, output, param_sets, sample_rate, max_block_size=512, offline=False, threads=0)\n--\n\n"
+      "Renders input through a fresh bank for every dict in param_sets, into\n"
+      "output[i], which must be (len(param_sets),) + input.shape. The sets run\n"
+      "in parallel on up to threads threads, 0 for one per core; offline banks\n"
+      "each render on their one thread." },
+    { "process_streams", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(process_streams)), METH_VARARGS | METH_KEYWORDS,
+      "process_streams(audio, sample_rate, params=None, max_block_size=512, threads=1)\n--\n\n"
+      "Filters a batch of independent streams, (streams, channels, samples) or\n"
+      "(streams, samples), in place, all with the same parameters and in SIMD\n"
+      "lanes side by side (see MultiStreamBank.h): faster than a Bank per stream\n"
+      "from a dozen or so streams up. Modulation sits at rest, every band runs\n"
+      "and there is no oversampling. threads 0 is one per core." },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+static PyModuleDef module = {
+    PyModuleDef_HEAD_INIT, "thesisdsp",
+    "The harmonic bank of the Thesis plugin, over NumPy arrays or any float buffer.",
+    -1, module_methods, nullptr, nullptr, nullptr, nullptr
+};
+
+PyMODINIT_FUNC PyInit_thesisdsp(void)
+{
+    BankType.tp_name = "thesisdsp.Bank";
+    BankType.tp_doc = "Bank(sample_rate, max_block_size=512, channels=2, params=None, offline=False)\n--\n\n"
+                      "One harmonic bank, prepared for the given rate, block size and channels.";
+    BankType.tp_basicsize = sizeof(BankObject);
+    BankType.tp_flags = Py_TPFLAGS_DEFAULT;
+    BankType.tp_new = PyType_GenericNew;
+    BankType.tp_init = reinterpret_cast<initproc>(Bank_init);
+    BankType.tp_dealloc = reinterpret_cast<destructor>(Bank_dealloc);
+    BankType.tp_methods = Bank_methods;
+
+    if (PyType_Ready(&BankType) < 0)
+        return nullptr;
+
+    PyObject* m = PyModule_Create(&module);
+
+    if (m == nullptr)
+        return nullptr;
+
+    Py_INCREF(&BankType);
+
+    if (PyModule_AddObject(m, "Bank", reinterpret_cast<PyObject*>(&BankType)) < 0)
+    {
+        Py_DECREF(&BankType);
+        Py_DECREF(m);
+        return nullptr;
+    }
+
+    return m;
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    BandMeters.cpp
+    Created: 24 Oct 2026 10:18:22am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "BandMeters.h"
+
+#include <algorithm>
+
+BandMeters::BandMeters(int newNumBands)
+    : capacity(std::max(newNumBands, 0)),
+      rmsValues(new std::atomic<float>[size_t(capacity)]),
+      peakValues(new std::atomic<float>[size_t(capacity)])
+{
+    for (int k = 0; k < capacity; k++)
+    {
+        rmsValues[size_t(k)].store(0.f, std::memory_order_relaxed);
+        peakValues[size_t(k)].store(0.f, std::memory_order_relaxed);
+    }
+}
+
+BandMeters::~BandMeters() {}
+
+void BandMeters::publish(const float* rms, const float* peak, int newNumBands)
+{
+    newNumBands = std::min(std::max(newNumBands, 0), capacity);
+
+    // odd while the values are changing
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // above the bands that ran, only what the last publish left up needs zeroing
+    const int numWritten = std::max(newNumBands, publishedBands);
+
+    for (int k = 0; k < numWritten; k++)
+    {
+        rmsValues[size_t(k)].store(k < newNumBands ? rms[k] : 0.f, std::memory_order_relaxed);
+        peakValues[size_t(k)].store(k < newNumBands ? peak[k] : 0.f, std::memory_order_relaxed);
+    }
+
+    numBands.store(newNumBands, std::memory_order_relaxed);
+    publishedBands = newNumBands;
+
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+int BandMeters::read(float* rms, float* peak, int maxBands) const
+{
+    const int n = std::min(std::max(maxBands, 0), capacity);
+
+    for (;;)
+    {
+        unsigned int before = sequence.load(std::memory_order_acquire);
+
+        if (before % 2 != 0)
+            continue;
+
+        for (int k = 0; k < n; k++)
+        {
+            if (rms != nullptr)
+                rms[k] = rmsValues[size_t(k)].load(std::memory_order_relaxed);
+            if (peak != nullptr)
+                peak[k] = peakValues[size_t(k)].load(std::memory_order_relaxed);
+        }
+
+        int count = numBands.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence.load(std::memory_order_relaxed) == before)
+            return count;
+    }
+}
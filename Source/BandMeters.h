@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    BandMeters.h
+    Created: 24 Oct 2026 10:18:22am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+/*
+    Per-band output levels, measured by the kernels as they run (see
+    BankKernels.h) and published by the bank once per process call: the RMS
+    and the peak of each harmonic's output, over the channels, for the last
+    block.
+
+    The audio thread writes a whole snapshot under a sequence count and
+    never waits; a reader copies it out and starts over if a publish landed
+    in the middle, so it always gets one block's values, never a mix of two.
+
+    Build with THESIS_BAND_METERS=0 to take the metering out of the kernels
+    altogether; the meters then read zero.
+*/
+
+#ifndef THESIS_BAND_METERS
+ #define THESIS_BAND_METERS 1
+#endif
+
+class BandMeters
+{
+public:
+    explicit BandMeters(int newNumBands);
+    ~BandMeters();
+
+    int getCapacity() const { return capacity; }
+
+    // audio thread: the first newNumBands bands, and zero above them
+    void publish(const float* rms, const float* peak, int newNumBands);
+
+    // Any thread: copies up to maxBands bands' RMS and peak (either may be
+    // nullptr) and returns how many bands the block ran.
+    int read(float* rms, float* peak, int maxBands) const;
+
+private:
+    int capacity;
+    std::atomic<unsigned int> sequence {0};
+    std::atomic<int> numBands {0};
+    int publishedBands {0};         // the audio thread's own copy
+    std::unique_ptr<std::atomic<float>[]> rmsValues;
+    std::unique_ptr<std::atomic<float>[]> peakValues;
+};
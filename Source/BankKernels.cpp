@@ -0,0 +1,275 @@
+/*
+  ==============================================================================
+
+    BankKernels.cpp
+    Created: 21 Oct 2026 1:52:18pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "BankKernels.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if KERNELS_X86 && defined(_MSC_VER) && ! defined(__clang__)
+ #include <intrin.h>
+#endif
+
+#define MEASURE_BLOCK   256
+#define MEASURE_REPS    8
+#define MEASURE_BANDS   200     // Quality 2, so the figure compares across builds
+#define SELECT_MARGIN   0.95f   // a wider variant has to take under this share of the time
+
+// The baseline: whatever the target guarantees without extra flags.
+namespace baseline
+{
+#if KERNELS_X86
+ #define KERNEL_ISA_ID      KERNEL_ISA_SSE2
+ #define KERNEL_ISA_NAME    "SSE2"
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #define KERNEL_ISA_ID      KERNEL_ISA_NEON
+ #define KERNEL_ISA_NAME    "NEON"
+#else
+ #define KERNEL_ISA_ID      KERNEL_ISA_GENERIC
+ #define KERNEL_ISA_NAME    "generic"
+#endif
+#define KERNEL_VECTOR_LANES 8
+
+#include "BankKernelsImpl.h"
+
+#undef KERNEL_ISA_ID
+#undef KERNEL_ISA_NAME
+#undef KERNEL_VECTOR_LANES
+}
+
+const KernelSet* getBaselineKernels()
+{
+    return &baseline::kernelSet;
+}
+
+//==============================================================================
+void KernelWork::allocate(int numBands)
+{
+    capacity = kernelTiers[getKernelTier(numBands)];
+
+    // whole cache lines per array, and room to start the first on one
+    const int lineFloats = 64 / int(sizeof(float));
+    const int stride = (capacity + lineFloats - 1) / lineFloats * lineFloats;
+    const int numArrays = 10 + 2 * MAX_CHANNELS;
+
+    std::vector<float>(size_t(numArrays * stride + lineFloats), 0.f).swap(storage);
+
+    float* base = storage.data();
+    while (reinterpret_cast<uintptr_t>(base) % 64 != 0)
+        base++;
+
+    float** arrays[] = { &g, &R2, &h, &cosR, &sinR, &drive, &gain, &gainStep, &energy, &peak };
+    for (auto* array : arrays)
+    {
+        *array = base;
+        base += stride;
+    }
+
+    for (int chan = 0; chan < MAX_CHANNELS; chan++)
+    {
+        s1[chan] = base;
+        s2[chan] = base + stride;
+        base += 2 * stride;
+    }
+}
+
+//==============================================================================
+static const char* const isaNames[NUM_KERNEL_ISAS] = { "generic", "sse2", "avx2", "avx512", "neon" };
+
+#if KERNELS_X86
+static bool cpuHasAvx2()
+{
+ #if defined(__GNUC__)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+ #elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+
+    // FMA, and the OS saving the ymm registers
+    if ((info[2] & (1 << 12)) == 0 || (info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+ #else
+    return false;
+ #endif
+}
+
+static bool cpuHasAvx512()
+{
+ #if defined(__GNUC__)
+    return cpuHasAvx2() && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl");
+ #elif defined(_MSC_VER)
+    // and the OS saving the opmask and zmm registers
+    if (! cpuHasAvx2() || (_xgetbv(0) & 0xe6) != 0xe6)
+        return false;
+
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 31)) != 0;
+ #else
+    return false;
+ #endif
+}
+#endif
+
+static const KernelSet* getKernels(KernelIsa isa)
+{
+    if (isa == getBaselineKernels()->isa)
+        return getBaselineKernels();
+
+#if KERNELS_X86
+    if (isa == KERNEL_ISA_AVX2 && cpuHasAvx2())
+        return getAvx2Kernels();
+    if (isa == KERNEL_ISA_AVX512 && cpuHasAvx512())
+        return getAvx512Kernels();
+#endif
+
+    return nullptr;
+}
+
+bool isKernelIsaSupported(KernelIsa isa)
+{
+    return getKernels(isa) != nullptr;
+}
+
+const char* getKernelIsaName(KernelIsa isa)
+{
+    if (isa < 0 || isa >= NUM_KERNEL_ISAS)
+        return "auto";
+
+    return isaNames[isa];
+}
+
+static std::atomic<int> kernelOverride { KERNEL_ISA_AUTO };
+
+void setKernelOverride(KernelIsa isa)
+{
+    kernelOverride = isa;
+}
+
+static KernelIsa getEnvironmentOverride()
+{
+    static const KernelIsa isa = []
+    {
+        const char* value = std::getenv("THESIS_KERNEL_ISA");
+
+        if (value != nullptr)
+            for (int i = 0; i < NUM_KERNEL_ISAS; i++)
+                if (std::strcmp(value, isaNames[i]) == 0)
+                    return KernelIsa(i);
+
+        return KERNEL_ISA_AUTO;
+    }();
+
+    return isa;
+}
+
+const KernelSet& selectKernels()
+{
+    int isa = kernelOverride.load();
+
+    if (isa == KERNEL_ISA_AUTO)
+        isa = getEnvironmentOverride();
+
+    if (isa != KERNEL_ISA_AUTO)
+        if (auto* kernels = getKernels(KernelIsa(isa)))
+            return *kernels;
+
+    // Wider is not always faster: AVX-512 can cost more in clock speed
+    // than its lanes win back, so every variant the CPU runs is timed, once
+    // per process, and a wider one only wins by a clear margin
+    static const KernelSet* const fastest = []
+    {
+        const KernelSet* best = getBaselineKernels();
+        float bestNs = measureKernelThroughput(*best);
+
+        for (KernelIsa candidate : { KERNEL_ISA_AVX2, KERNEL_ISA_AVX512 })
+        {
+            if (auto* kernels = getKernels(candidate))
+            {
+                float ns = measureKernelThroughput(*kernels);
+
+                if (ns < bestNs * SELECT_MARGIN)
+                {
+                    best = kernels;
+                    bestNs = ns;
+                }
+            }
+        }
+
+        return best;
+    }();
+
+    return *fastest;
+}
+
+//==============================================================================
+float measureKernelThroughput(const KernelSet& kernels)
+{
+    static std::atomic<float> measured[NUM_KERNEL_ISAS];
+
+    float cached = measured[kernels.isa].load(std::memory_order_relaxed);
+    if (cached > 0)
+        return cached;
+
+    // every band running, spread over the spectrum, fed white noise
+    auto work = std::make_unique<KernelWork>();
+    work->allocate(MEASURE_BANDS);
+
+    for (int k = 0; k < MEASURE_BANDS; k++)
+    {
+        work->g[k] = std::tan(3.14159265f * float(k + 1) * 100.f / 48000.f);
+        work->R2[k] = 0.05f;
+        work->gain[k] = 1.0e-3f;
+    }
+
+    kernels.updateH(work->g, work->R2, work->h, MEASURE_BANDS);
+
+    std::vector<float> noise(MAX_CHANNELS * MEASURE_BLOCK), buffer(noise.size());
+    unsigned int seed = 1;
+    for (auto& sample : noise)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        sample = float(seed >> 8) / float(1 << 24) - 0.5f;
+    }
+
+    float* channels[MAX_CHANNELS];
+    for (int chan = 0; chan < MAX_CHANNELS; chan++)
+        channels[chan] = &buffer[size_t(chan * MEASURE_BLOCK)];
+
+    BankKernel kernel = kernels.bands[getKernelTier(MEASURE_BANDS)][MAX_CHANNELS - 1];
+    double seconds = 0;
+
+    // the first pass only warms up
+    for (int rep = 0; rep <= MEASURE_REPS; rep++)
+    {
+        std::memcpy(buffer.data(), noise.data(), sizeof(float) * noise.size());
+
+        auto start = std::chrono::steady_clock::now();
+        kernel(*work, channels, MEASURE_BLOCK);
+
+        if (rep > 0)
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    float ns = float(seconds * 1.0e9 / (double(MEASURE_BANDS) * MAX_CHANNELS * MEASURE_BLOCK * MEASURE_REPS));
+
+    measured[kernels.isa].store(ns, std::memory_order_relaxed);
+
+    return ns;
+}
@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    BankKernels.h
+    Created: 19 Oct 2026 2:21:30pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "HarmonicBank.h"
+
+/*
+    Per-sample kernels for the harmonic bank, specialised at compile time on
+    the number of bands (rounded up to a tier) and on the channel count.
+
+    The bank gathers the bands it is running this block into KernelWork,
+    padded up to the tier with inert bands (g = h = gain = 0, which keep a
+    zero state and add nothing). With a fixed trip count and the bands laid
+    out side by side, the band loop has no branches and the compiler can
+    unroll it and run a vector's worth of bands per operation. The partial
+    sums are kept per lane so the vectoriser never has to reorder a float
+    reduction.
+
+    The kernels themselves are in BankKernelsImpl.h, which is compiled once
+    per instruction set into its own KernelSet: the baseline build
+    (BankKernels.cpp: SSE2 on x86-64, NEON on arm64), AVX2/FMA
+    (BankKernelsAVX2.cpp) and AVX-512 with 16-wide lanes
+    (BankKernelsAVX512.cpp). selectKernels times the ones the CPU runs and
+    picks the fastest.
+
+    With THESIS_BAND_METERS on, the kernels also meter every band they run
+    (see BandMeters.h). Adding each band's square and peak on every sample
+    adds two loads and two stores per band-sample to a loop that is bound
+    by them, about two thirds more time, so only one sample in about every
+    METER_STRIDE is metered, at random spacing, and the rest run the
+    unmetered loop. Each metered sample reads the band's envelope rather
+    than its output, so a sparse sample is still a steady reading. At 64
+    the kernels measure under 2% slower than without the meters (median
+    over the tiers and instruction sets), inside the 3% budget.
+
+    The stream kernels turn the vectors the other way, for MultiStreamBank:
+    many independent signals through one set of bands, a lane per channel
+    of each. STREAM_GROUP bands at a time run over a tile of STREAM_TILE
+    lanes for STREAM_CHUNK samples, their coefficients held as scalars and
+    the lanes' states in registers, so each vector operation covers as many
+    streams and there is no sum across the vector at all. Fewer bands or a
+    wider tile leave the SVF waiting on its own latency. With
+    benchmarkStreams at 64 stereo streams and 100 bands (48 kHz, 512-sample
+    blocks, g++ 12.2 -O3, on a shared Xeon where runs vary by a fifth),
+    this measured 1.9-2.3x faster than a bank per stream with AVX-512,
+    1.5-1.6x with AVX2 and 1.2-1.5x with SSE2. A tile is mostly padding
+    below a dozen streams or so, where separate banks win.
+*/
+
+#define KERNEL_LANES    8       // every tier is a whole number of these
+#define NUM_TIERS       10
+#define METER_STRIDE    64      // samples per metered sample, on average
+#define STREAM_TILE     32      // lanes a stream kernel runs each band over at once...
+#define STREAM_CHUNK    64      // ...for this many samples, so the tile's input and sums stay in L1...
+#define STREAM_GROUP    4       // ...this many bands to a pass
+
+// the arrays are only ever reached through KernelWork's pointers, which
+// never overlap
+#define KERNEL_RESTRICT __restrict
+
+// Compilers only reliably keep restrict for the parameters of a function
+// that stays a function: inlined into the sample loop, the band sweeps lose
+// it and are vectorised behind overlap checks, or not at all.
+#if defined(_MSC_VER)
+ #define KERNEL_NOINLINE __declspec(noinline)
+#else
+ #define KERNEL_NOINLINE __attribute__((noinline))
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define KERNELS_X86    1
+#else
+ #define KERNELS_X86    0
+#endif
+
+static const int kernelTiers[NUM_TIERS] = { 8, 16, 32, 56, 104, 152, 200, 400, 800, MAX_HARM };
+
+enum KernelIsa
+{
+    KERNEL_ISA_AUTO = -1,       // for setKernelOverride: back to detection
+    KERNEL_ISA_GENERIC,         // baseline build on anything but x86 or arm64
+    KERNEL_ISA_SSE2,
+    KERNEL_ISA_AVX2,
+    KERNEL_ISA_AVX512,
+    KERNEL_ISA_NEON,
+    NUM_KERNEL_ISAS
+};
+
+// Everything the kernel touches per sample, and nothing else: one block,
+// sized for the tier that holds the bank's harmonics, with each array on
+// its own cache lines.
+struct KernelWork
+{
+    float* g {nullptr};
+    float* R2 {nullptr};
+    float* h {nullptr};
+    float* cosR {nullptr};          // modal engine
+    float* sinR {nullptr};
+    float* drive {nullptr};
+    float* gain {nullptr};          // fused gain at the start of the block...
+    float* gainStep {nullptr};      // ...and its per-sample ramp
+    float* s1[MAX_CHANNELS] {};
+    float* s2[MAX_CHANNELS] {};
+
+    // band meters since the bank last cleared them: each band's mean
+    // square output summed over the metered samples of every channel, its
+    // largest squared envelope, and how many samples were metered
+    float* energy {nullptr};
+    float* peak {nullptr};
+    int meterCount {0};
+    int meterNext {0};              // samples into the next call to meter next
+    uint32_t meterSeed {1};
+
+    // room for the tier that holds numBands; allocates, and zeroes everything
+    void allocate(int numBands);
+    int getCapacity() const { return capacity; }
+
+private:
+    std::vector<float> storage;
+    int capacity {0};
+};
+
+typedef void (*BankKernel)(KernelWork& work, float* const* channels, int numSamples);
+
+// What the stream kernels run: the bands' coefficients indexed by harmonic
+// (a CoeffSet's arrays), which harmonics to run, and their states, each
+// harmonic's numLanes side by side.
+struct StreamWork
+{
+    const float* g {nullptr};
+    const float* R2 {nullptr};
+    const float* h {nullptr};
+    const float* cosR {nullptr};
+    const float* sinR {nullptr};
+    const float* drive {nullptr};
+    const float* gain {nullptr};
+    const int* bands {nullptr};
+    int numBands {0};
+    float* s1 {nullptr};
+    float* s2 {nullptr};
+    int numLanes {0};               // a whole number of STREAM_TILE
+};
+
+// The tile of lanes from firstLane through every band: in holds the tile's
+// block, STREAM_TILE samples (one per lane) to a sample time, and out gets
+// the output laid out the same way.
+typedef void (*StreamKernel)(const StreamWork& work, const float* in, float* out, int firstLane, int numSamples);
+
+// h = 1 / (1 + R2 g + g^2) for the SVF, over numBands bands
+typedef void (*CoeffKernel)(const float* g, const float* R2, float* h, int numBands);
+
+struct KernelSet
+{
+    KernelIsa isa;
+    const char* name;
+    BankKernel bands[NUM_TIERS][MAX_CHANNELS];
+    BankKernel modes[NUM_TIERS][MAX_CHANNELS];
+    StreamKernel streamBands;
+    StreamKernel streamModes;
+    CoeffKernel updateH;
+};
+
+// smallest tier that holds numBands
+inline int getKernelTier(int numBands)
+{
+    for (int tier = 0; tier < NUM_TIERS; tier++)
+        if (numBands <= kernelTiers[tier])
+            return tier;
+
+    return NUM_TIERS - 1;
+}
+
+// each variant, or nullptr where it was not built for this target
+const KernelSet* getBaselineKernels();
+const KernelSet* getAvx2Kernels();
+const KernelSet* getAvx512Kernels();
+
+// The fastest variant that is built and that this CPU runs, timed with
+// measureKernelThroughput the first time it is asked for, unless an
+// override is set, either with setKernelOverride or (read once) through
+// the THESIS_KERNEL_ISA environment variable: sse2, avx2, avx512, neon or
+// generic. An override the CPU cannot run falls back to detection.
+const KernelSet& selectKernels();
+void setKernelOverride(KernelIsa isa);
+bool isKernelIsaSupported(KernelIsa isa);
+const char* getKernelIsaName(KernelIsa isa);
+
+// Nanoseconds per band-sample of the full-size stereo SVF kernel, timed
+// the first time each variant is asked for and cached after that.
+float measureKernelThroughput(const KernelSet& kernels);
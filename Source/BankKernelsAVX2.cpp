@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    BankKernelsAVX2.cpp
+    Created: 21 Oct 2026 1:52:18pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "BankKernels.h"
+
+// GCC and Clang build this file for AVX2/FMA whatever the project flags
+// say; MSVC only when the file itself is compiled with /arch:AVX2.
+#if KERNELS_X86 && (defined(__GNUC__) || defined(__AVX2__))
+ #define KERNELS_AVX2   1
+#else
+ #define KERNELS_AVX2   0
+#endif
+
+#if KERNELS_AVX2
+ #if defined(__clang__)
+  #pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+ #elif defined(__GNUC__)
+  #pragma GCC push_options
+  #pragma GCC target("avx2,fma")
+ #endif
+
+namespace avx2
+{
+#define KERNEL_ISA_ID       KERNEL_ISA_AVX2
+#define KERNEL_ISA_NAME     "AVX2/FMA"
+#define KERNEL_VECTOR_LANES 8
+
+#include "BankKernelsImpl.h"
+
+#undef KERNEL_ISA_ID
+#undef KERNEL_ISA_NAME
+#undef KERNEL_VECTOR_LANES
+}
+
+ #if defined(__clang__)
+  #pragma clang attribute pop
+ #elif defined(__GNUC__)
+  #pragma GCC pop_options
+ #endif
+#endif
+
+const KernelSet* getAvx2Kernels()
+{
+#if KERNELS_AVX2
+    return &avx2::kernelSet;
+#else
+    return nullptr;
+#endif
+}
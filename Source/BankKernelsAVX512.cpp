@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    BankKernelsAVX512.cpp
+    Created: 21 Oct 2026 1:52:18pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "BankKernels.h"
+
+// GCC and Clang build this file for AVX-512 (F and VL) whatever the project
+// flags say; MSVC only when the file itself is compiled with /arch:AVX512.
+// GCC otherwise prefers 256-bit vectors even with AVX-512 enabled.
+#if KERNELS_X86 && (defined(__GNUC__) || defined(__AVX512F__))
+ #define KERNELS_AVX512   1
+#else
+ #define KERNELS_AVX512   0
+#endif
+
+#if KERNELS_AVX512
+ #if defined(__clang__)
+  #pragma clang attribute push (__attribute__((target("avx2,fma,avx512f,avx512vl"))), apply_to = function)
+ #elif defined(__GNUC__)
+  #pragma GCC push_options
+  #pragma GCC target("avx2,fma,avx512f,avx512vl,prefer-vector-width=512")
+ #endif
+
+namespace avx512
+{
+#define KERNEL_ISA_ID       KERNEL_ISA_AVX512
+#define KERNEL_ISA_NAME     "AVX-512"
+#define KERNEL_VECTOR_LANES 16
+
+#include "BankKernelsImpl.h"
+
+#undef KERNEL_ISA_ID
+#undef KERNEL_ISA_NAME
+#undef KERNEL_VECTOR_LANES
+}
+
+ #if defined(__clang__)
+  #pragma clang attribute pop
+ #elif defined(__GNUC__)
+  #pragma GCC pop_options
+ #endif
+#endif
+
+const KernelSet* getAvx512Kernels()
+{
+#if KERNELS_AVX512
+    return &avx512::kernelSet;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,354 @@
+/*
+  ==============================================================================
+
+    BankKernelsImpl.h
+    Created: 21 Oct 2026 1:52:18pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+/*
+    The kernel bodies behind BankKernels.h. Deliberately without an include
+    guard: each instruction set's translation unit includes this inside its
+    own namespace, after switching the compiler's target, with
+
+        KERNEL_VECTOR_LANES     lanes per partial sum (8, or 16 for AVX-512)
+        KERNEL_ISA_ID           the KernelIsa it is built for
+        KERNEL_ISA_NAME         and its name
+
+    and gets a kernelSet out of it.
+*/
+
+static_assert(KERNEL_VECTOR_LANES % KERNEL_LANES == 0, "vectors must hold whole tiers' lanes");
+
+// samples from one metered sample to the next: 1 to 2 METER_STRIDE - 1
+inline int nextMeterGap(KernelWork& work)
+{
+    work.meterSeed = work.meterSeed * 1664525u + 1013904223u;
+    return 1 + int((work.meterSeed >> 16) % (2 * METER_STRIDE - 1));
+}
+
+// Adds one band to the meters from its output y and the signal in
+// quadrature with it, z: the SVF's low-pass, which matches the band-pass in
+// level at the centre frequency, or the phasor's imaginary part. Together
+// they give the squared envelope, so one sample measures the band's level
+// at any phase: half of it is the output's mean square, and the largest is
+// kept as the peak (squared, which saves a root per band-sample). Taken
+// from y and gain apart rather than from the product the band adds to the
+// sum, which the compiler can still fuse into that add, so metering leaves
+// the output bit for bit as it was.
+inline void meterBand(float* KERNEL_RESTRICT energy, float* KERNEL_RESTRICT peak, int k,
+                      float y, float z, float gain)
+{
+    float envelope = (y * y + z * z) * (gain * gain);
+
+    energy[k] += 0.5f * envelope;
+    peak[k] = envelope > peak[k] ? envelope : peak[k];
+}
+
+// One sample of one channel through every band, returning their sum. The
+// arrays come in as restrict parameters, which is what lets the compiler
+// vectorise across bands without checking them for overlap.
+template <int NumBands, bool Metered>
+KERNEL_NOINLINE float sweepBands(const float* KERNEL_RESTRICT g, const float* KERNEL_RESTRICT R2,
+                                 const float* KERNEL_RESTRICT h, const float* KERNEL_RESTRICT gain,
+                                 float* KERNEL_RESTRICT s1, float* KERNEL_RESTRICT s2,
+                                 float* KERNEL_RESTRICT energy, float* KERNEL_RESTRICT peak, float x)
+{
+    static_assert(NumBands % KERNEL_LANES == 0, "tiers must be a whole number of lanes");
+
+    // whole vectors first; a 16-lane build finishes odd tiers with 8
+    constexpr int numWhole = NumBands - NumBands % KERNEL_VECTOR_LANES;
+
+    auto band = [&](int k)
+    {
+        const float gk = g[k], state1 = s1[k], state2 = s2[k];
+
+        float yHP = h[k] * (x - state1 * (gk + R2[k]) - state2);
+
+        float yBP = yHP * gk + state1;
+        s1[k] = yHP * gk + yBP;
+
+        float yLP = yBP * gk + state2;
+        s2[k] = yBP * gk + yLP;
+
+        if (Metered)
+            meterBand(energy, peak, k, yBP, yLP, gain[k]);
+
+        return yBP * gain[k];
+    };
+
+    float partial[KERNEL_VECTOR_LANES] = {};
+
+    for (int b = 0; b < numWhole; b += KERNEL_VECTOR_LANES)
+        for (int l = 0; l < KERNEL_VECTOR_LANES; l++)
+            partial[l] += band(b + l);
+
+    for (int k = numWhole; k < NumBands; k++)
+        partial[k - numWhole] += band(k);
+
+    float sum = 0;
+    for (int l = 0; l < KERNEL_VECTOR_LANES; l++)
+        sum += partial[l];
+
+    return sum;
+}
+
+// The modal engine: each band is a phasor z = re + j im that is rotated and
+// shrunk by the pole r e^(j theta) every sample and driven by the input,
+//     z = r e^(j theta) z + drive x,   y = re(z)
+// Four multiplies and no divide or shared intermediate per band-sample.
+template <int NumBands, bool Metered>
+KERNEL_NOINLINE float sweepModes(const float* KERNEL_RESTRICT cosR, const float* KERNEL_RESTRICT sinR,
+                                 const float* KERNEL_RESTRICT drive, const float* KERNEL_RESTRICT gain,
+                                 float* KERNEL_RESTRICT re, float* KERNEL_RESTRICT im,
+                                 float* KERNEL_RESTRICT energy, float* KERNEL_RESTRICT peak, float x)
+{
+    static_assert(NumBands % KERNEL_LANES == 0, "tiers must be a whole number of lanes");
+
+    constexpr int numWhole = NumBands - NumBands % KERNEL_VECTOR_LANES;
+
+    auto mode = [&](int k)
+    {
+        float newRe = cosR[k] * re[k] - sinR[k] * im[k] + drive[k] * x;
+        float newIm = sinR[k] * re[k] + cosR[k] * im[k];
+
+        re[k] = newRe;
+        im[k] = newIm;
+
+        if (Metered)
+            meterBand(energy, peak, k, newRe, newIm, gain[k]);
+
+        return newRe * gain[k];
+    };
+
+    float partial[KERNEL_VECTOR_LANES] = {};
+
+    for (int b = 0; b < numWhole; b += KERNEL_VECTOR_LANES)
+        for (int l = 0; l < KERNEL_VECTOR_LANES; l++)
+            partial[l] += mode(b + l);
+
+    for (int k = numWhole; k < NumBands; k++)
+        partial[k - numWhole] += mode(k);
+
+    float sum = 0;
+    for (int l = 0; l < KERNEL_VECTOR_LANES; l++)
+        sum += partial[l];
+
+    return sum;
+}
+
+template <int NumBands>
+inline void rampGains(float* KERNEL_RESTRICT gain, const float* KERNEL_RESTRICT gainStep)
+{
+    for (int k = 0; k < NumBands; k++)
+        gain[k] += gainStep[k];
+}
+
+// sample n of every channel through the bank
+template <int NumBands, int NumChannels, bool Modal, bool Metered>
+inline void runSample(KernelWork& work, float* const* channels, int n)
+{
+    for (int chan = 0; chan < NumChannels; chan++)
+    {
+        float& x = channels[chan][n];
+
+        if (Modal)
+            x = sweepModes<NumBands, Metered>(work.cosR, work.sinR, work.drive, work.gain,
+                                              work.s1[chan], work.s2[chan], work.energy, work.peak, x);
+        else
+            x = sweepBands<NumBands, Metered>(work.g, work.R2, work.h, work.gain,
+                                              work.s1[chan], work.s2[chan], work.energy, work.peak, x);
+    }
+
+    rampGains<NumBands>(work.gain, work.gainStep);
+}
+
+template <int NumBands, int NumChannels, bool Modal>
+void processBank(KernelWork& work, float* const* channels, int numSamples)
+{
+    int n = 0;
+
+   #if THESIS_BAND_METERS
+    // one sample in about every METER_STRIDE also meters the bands, at
+    // random spacing so a partial locked to the stride is not sampled at
+    // the same phase every time
+    for (; work.meterNext < numSamples; work.meterNext += nextMeterGap(work))
+    {
+        for (; n < work.meterNext; n++)
+            runSample<NumBands, NumChannels, Modal, false>(work, channels, n);
+
+        runSample<NumBands, NumChannels, Modal, true>(work, channels, n++);
+        work.meterCount++;
+    }
+
+    work.meterNext -= numSamples;
+   #endif
+
+    for (; n < numSamples; n++)
+        runSample<NumBands, NumChannels, Modal, false>(work, channels, n);
+}
+
+template <int NumBands, int NumChannels>
+void processBands(KernelWork& work, float* const* channels, int numSamples)
+{
+    processBank<NumBands, NumChannels, false>(work, channels, numSamples);
+}
+
+template <int NumBands, int NumChannels>
+void processModes(KernelWork& work, float* const* channels, int numSamples)
+{
+    processBank<NumBands, NumChannels, true>(work, channels, numSamples);
+}
+
+//==============================================================================
+// NumBands bands over a chunk of a tile's lanes. The lanes are independent
+// signals, so the coefficients are scalars for the whole chunk and the lane
+// loop vectorises with nothing to reduce. A band's next sample waits on a
+// chain of dependent multiply-adds, so the bands run side by side in the
+// lane loop and their chains overlap; one band at a time would leave the
+// few vectors of a tile waiting on latency. The same arithmetic as
+// sweepBands, band for band, but added up in another order.
+template <int NumBands, bool Modal>
+KERNEL_NOINLINE void sweepStreamBands(const StreamWork& work, const int* KERNEL_RESTRICT harms, size_t firstLane,
+                                      const float* KERNEL_RESTRICT in, float* KERNEL_RESTRICT sum, int numSamples)
+{
+    // the SVF's g, g + R2 and h, or the phasor's cosR, sinR and drive
+    float c0[NumBands], c1[NumBands], c2[NumBands], gain[NumBands];
+    float state1[NumBands][STREAM_TILE], state2[NumBands][STREAM_TILE];
+
+    for (int b = 0; b < NumBands; b++)
+    {
+        const int harm = harms[b];
+        const float* s1 = work.s1 + size_t(harm) * size_t(work.numLanes) + firstLane;
+        const float* s2 = work.s2 + size_t(harm) * size_t(work.numLanes) + firstLane;
+
+        c0[b] = Modal ? work.cosR[harm] : work.g[harm];
+        c1[b] = Modal ? work.sinR[harm] : work.g[harm] + work.R2[harm];
+        c2[b] = Modal ? work.drive[harm] : work.h[harm];
+        gain[b] = work.gain[harm];
+
+        for (int l = 0; l < STREAM_TILE; l++)
+        {
+            state1[b][l] = s1[l];
+            state2[b][l] = s2[l];
+        }
+    }
+
+    for (int n = 0; n < numSamples; n++)
+    {
+        const float* x = in + n * STREAM_TILE;
+        float* y = sum + n * STREAM_TILE;
+
+        for (int l = 0; l < STREAM_TILE; l++)
+        {
+            float out = 0;
+
+            for (int b = 0; b < NumBands; b++)
+            {
+                if (Modal)
+                {
+                    float newRe = c0[b] * state1[b][l] - c1[b] * state2[b][l] + c2[b] * x[l];
+                    float newIm = c1[b] * state1[b][l] + c0[b] * state2[b][l];
+
+                    state1[b][l] = newRe;
+                    state2[b][l] = newIm;
+
+                    out += newRe * gain[b];
+                }
+                else
+                {
+                    float yHP = c2[b] * (x[l] - state1[b][l] * c1[b] - state2[b][l]);
+
+                    float yBP = yHP * c0[b] + state1[b][l];
+                    state1[b][l] = yHP * c0[b] + yBP;
+
+                    float yLP = yBP * c0[b] + state2[b][l];
+                    state2[b][l] = yBP * c0[b] + yLP;
+
+                    out += yBP * gain[b];
+                }
+            }
+
+            y[l] += out;
+        }
+    }
+
+    // same denormal guard as HarmonicBank::scatterBands
+    for (int b = 0; b < NumBands; b++)
+    {
+        float* KERNEL_RESTRICT s1 = work.s1 + size_t(harms[b]) * size_t(work.numLanes) + firstLane;
+        float* KERNEL_RESTRICT s2 = work.s2 + size_t(harms[b]) * size_t(work.numLanes) + firstLane;
+
+        for (int l = 0; l < STREAM_TILE; l++)
+        {
+            s1[l] = state1[b][l] < 1.0e-8f && state1[b][l] > -1.0e-8f ? 0.f : state1[b][l];
+            s2[l] = state2[b][l] < 1.0e-8f && state2[b][l] > -1.0e-8f ? 0.f : state2[b][l];
+        }
+    }
+}
+
+// one tile through every band, STREAM_CHUNK samples and STREAM_GROUP bands
+// at a time
+template <bool Modal>
+void processStreams(const StreamWork& work, const float* in, float* out, int firstLane, int numSamples)
+{
+    for (int start = 0; start < numSamples; start += STREAM_CHUNK)
+    {
+        const int chunk = numSamples - start < STREAM_CHUNK ? numSamples - start : STREAM_CHUNK;
+        const float* x = in + start * STREAM_TILE;
+        float* sum = out + start * STREAM_TILE;
+
+        for (int i = 0; i < chunk * STREAM_TILE; i++)
+            sum[i] = 0;
+
+        int b = 0;
+
+        for (; b + STREAM_GROUP <= work.numBands; b += STREAM_GROUP)
+            sweepStreamBands<STREAM_GROUP, Modal>(work, work.bands + b, size_t(firstLane), x, sum, chunk);
+
+        for (; b < work.numBands; b++)
+            sweepStreamBands<1, Modal>(work, work.bands + b, size_t(firstLane), x, sum, chunk);
+    }
+}
+
+static void updateH(const float* g, const float* R2, float* h, int numBands)
+{
+    for (int k = 0; k < numBands; k++)
+        h[k] = 1.f / (1.f + R2[k] * g[k] + g[k] * g[k]);
+}
+
+// only function addresses, so this is constant-initialised and no code
+// built for this instruction set runs before the CPU has been checked
+static const KernelSet kernelSet = {
+    KERNEL_ISA_ID,
+    KERNEL_ISA_NAME,
+    {
+        { processBands<8, 1>,           processBands<8, 2>          },
+        { processBands<16, 1>,          processBands<16, 2>         },
+        { processBands<32, 1>,          processBands<32, 2>         },
+        { processBands<56, 1>,          processBands<56, 2>         },
+        { processBands<104, 1>,         processBands<104, 2>        },
+        { processBands<152, 1>,         processBands<152, 2>        },
+        { processBands<200, 1>,         processBands<200, 2>        },
+        { processBands<400, 1>,         processBands<400, 2>        },
+        { processBands<800, 1>,         processBands<800, 2>        },
+        { processBands<MAX_HARM, 1>,    processBands<MAX_HARM, 2>   },
+    },
+    {
+        { processModes<8, 1>,           processModes<8, 2>          },
+        { processModes<16, 1>,          processModes<16, 2>         },
+        { processModes<32, 1>,          processModes<32, 2>         },
+        { processModes<56, 1>,          processModes<56, 2>         },
+        { processModes<104, 1>,         processModes<104, 2>        },
+        { processModes<152, 1>,         processModes<152, 2>        },
+        { processModes<200, 1>,         processModes<200, 2>        },
+        { processModes<400, 1>,         processModes<400, 2>        },
+        { processModes<800, 1>,         processModes<800, 2>        },
+        { processModes<MAX_HARM, 1>,    processModes<MAX_HARM, 2>   },
+    },
+    processStreams<false>,
+    processStreams<true>,
+    updateH,
+};
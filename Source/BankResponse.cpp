@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    BankResponse.cpp
+    Created: 20 Oct 2026 11:02:37am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "BankResponse.h"
+
+#include <algorithm>
+#include <cmath>
+
+// frequencies evaluated together; small enough that everything stays in L1
+#define RESPONSE_CHUNK  64
+
+static const double pi = 3.14159265358979323846;
+
+// adds the bands running at factor times the base rate onto sumRe / sumIm
+static void accumulateChunk(const CoeffSet& coeffs, int factor, double rate, const float* freqs, int count,
+                            float* sumRe, float* sumIm)
+{
+    // per frequency: sin^2(w/2), sin^2(w), cos(w), sin(w), sin(2w)
+    float halfSq[RESPONSE_CHUNK] = {}, fullSq[RESPONSE_CHUNK] = {};
+    float cos1[RESPONSE_CHUNK] = {}, sin1[RESPONSE_CHUNK] = {}, sin2[RESPONSE_CHUNK] = {};
+
+    for (int f = 0; f < count; f++)
+    {
+        double w = 2.0 * pi * freqs[f] / rate;
+        double s = std::sin(w / 2.0);
+        double c = std::cos(w / 2.0);
+
+        halfSq[f] = float(s * s);
+        sin1[f] = float(2.0 * s * c);
+        cos1[f] = float(1.0 - 2.0 * s * s);
+        fullSq[f] = sin1[f] * sin1[f];
+        sin2[f] = 2.f * sin1[f] * cos1[f];
+    }
+
+    // bands outer, frequencies inner: the inner loop runs the whole chunk
+    // with no reduction, so it vectorises without reordering any sums
+    for (int b = 0; b < coeffs.numActive; b++)
+    {
+        float gain = coeffs.gain[size_t(b)];
+
+        if (gain == 0.f || coeffs.oversample[size_t(b)] != factor)
+            continue;
+
+        if (coeffs.engine == ENGINE_MODAL)
+        {
+            // re(z) of a one-pole resonator driven by a real input sees the
+            // pole and its conjugate:
+            //     H = drive / 2 (1 / (1 - p e^-jw) + 1 / (1 - p* e^-jw))
+            float pr = coeffs.cosR[size_t(b)];
+            float pim = coeffs.sinR[size_t(b)];
+            float scale = 0.5f * gain * coeffs.drive[size_t(b)];
+
+            for (int f = 0; f < RESPONSE_CHUNK; f++)
+            {
+                float d1 = 1.f - (pr * cos1[f] + pim * sin1[f]);
+                float e1 = pr * sin1[f] - pim * cos1[f];
+                float d2 = 1.f - (pr * cos1[f] - pim * sin1[f]);
+                float e2 = pr * sin1[f] + pim * cos1[f];
+
+                float inv1 = scale / (d1 * d1 + e1 * e1);
+                float inv2 = scale / (d2 * d2 + e2 * e2);
+
+                sumRe[f] += d1 * inv1 + d2 * inv2;
+                sumIm[f] -= e1 * inv1 + e2 * inv2;
+            }
+
+            continue;
+        }
+
+        float g = coeffs.g[size_t(b)];
+        float k = coeffs.R2[size_t(b)];
+        float gg = g * g;
+
+        // Re(D) = 4g^2 + 4(1 - g^2) sin^2(w/2) - 2(1 - kg + g^2) sin^2(w)
+        // Im(D) = -2 sin(w) (g^2 + cos(w) (g^2 - kg) - 2 sin^2(w/2))
+        float dr0 = 4.f * gg;
+        float dr1 = 4.f * (1.f - gg);
+        float dr2 = 2.f * (1.f - k * g + gg);
+        float di1 = gg - k * g;
+        float num = gain * g;
+
+        for (int f = 0; f < RESPONSE_CHUNK; f++)
+        {
+            // N = g (1 - e^-2jw) = g (2 sin^2(w) + j sin(2w))
+            float nr = num * 2.f * fullSq[f];
+            float ni = num * sin2[f];
+
+            float dr = dr0 + dr1 * halfSq[f] - dr2 * fullSq[f];
+            float di = -2.f * sin1[f] * (gg + cos1[f] * di1 - 2.f * halfSq[f]);
+
+            float inv = 1.f / (dr * dr + di * di);
+
+            sumRe[f] += (nr * dr + ni * di) * inv;
+            sumIm[f] += (ni * dr - nr * di) * inv;
+        }
+    }
+}
+
+static void evaluateChunk(const CoeffSet& coeffs, double sampleRate, const float* freqs, int count,
+                          float* magnitude, float* phase)
+{
+    float sumRe[RESPONSE_CHUNK] = {}, sumIm[RESPONSE_CHUNK] = {};
+
+    accumulateChunk(coeffs, 1, sampleRate, freqs, count, sumRe, sumIm);
+
+    // the oversampled top octave, at its own rate
+    int factor = *std::max_element(coeffs.oversample.begin(), coeffs.oversample.begin() + coeffs.numActive);
+
+    if (factor > 1)
+        accumulateChunk(coeffs, factor, sampleRate * factor, freqs, count, sumRe, sumIm);
+
+    for (int f = 0; f < count; f++)
+    {
+        magnitude[f] = std::sqrt(sumRe[f] * sumRe[f] + sumIm[f] * sumIm[f]);
+
+        if (phase != nullptr)
+            phase[f] = std::atan2(sumIm[f], sumRe[f]);
+    }
+}
+
+ResponseSnapshot makeResponseSnapshot(const BankSettings& settings, double sampleRate,
+                                      std::shared_ptr<const PartialMap> map)
+{
+    ResponseSnapshot snapshot;
+
+    snapshot.sampleRate = sampleRate;
+    snapshot.coeffs = HarmonicBank::computeCoefficientSet(settings, sampleRate, std::move(map));
+
+    return snapshot;
+}
+
+void computeResponse(const ResponseSnapshot& snapshot,
+                     const float* freqs,
+                     int numFreqs,
+                     float* magnitude,
+                     float* phase)
+{
+    if (numFreqs <= 0)
+        return;
+
+    const CoeffSet* coeffs = snapshot.coeffs.get();
+
+    // no band below nyquist: the bank passes its input through
+    if (coeffs == nullptr || coeffs->numActive == 0)
+    {
+        for (int f = 0; f < numFreqs; f++)
+        {
+            magnitude[f] = 1.f;
+            if (phase != nullptr)
+                phase[f] = 0.f;
+        }
+        return;
+    }
+
+    for (int start = 0; start < numFreqs; start += RESPONSE_CHUNK)
+    {
+        int count = std::min(RESPONSE_CHUNK, numFreqs - start);
+
+        evaluateChunk(*coeffs, snapshot.sampleRate, freqs + start, count,
+                      magnitude + start, phase != nullptr ? phase + start : nullptr);
+    }
+}
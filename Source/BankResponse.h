@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    BankResponse.h
+    Created: 20 Oct 2026 11:02:37am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "HarmonicBank.h"
+
+/*
+    The bank's transfer function without rendering any audio. Each band is
+    the TPT band-pass output
+
+        H(z) = g (1 - z^-2) / ((1 + kg + g^2) + (2g^2 - 2) z^-1 + (1 - kg + g^2) z^-2)
+
+    with k = R2, scaled by the band's fused gain, and the bank is the sum of
+    its bands. The denominator is evaluated in terms of sin^2(w/2) so the
+    narrow low bands do not lose their peak to cancellation in float.
+
+    For the modal engine each band is instead the real part of a driven
+    complex one-pole, which responds to both the pole and its conjugate.
+
+    Oversampled bands are evaluated at their own rate. The half-band
+    filters around them are left out: they are flat to 0.005 dB up to
+    0.9 nyquist, and their delay is the same for every band.
+
+    A snapshot holds an immutable coefficient set, so it can be taken and
+    evaluated on any thread while the audio thread keeps running.
+*/
+
+struct ResponseSnapshot
+{
+    double sampleRate {44100.0};
+    std::shared_ptr<const CoeffSet> coeffs;
+};
+
+// coefficients for these settings (and partial map, if any) with any
+// modulation at rest; may block on the shared table lock, so keep it off
+// the audio thread
+ResponseSnapshot makeResponseSnapshot(const BankSettings& settings, double sampleRate,
+                                      std::shared_ptr<const PartialMap> map = nullptr);
+
+// linear magnitude (and, if phase is not null, phase in radians) of the
+// whole bank at numFreqs frequencies in Hz
+void computeResponse(const ResponseSnapshot& snapshot,
+                     const float* freqs,
+                     int numFreqs,
+                     float* magnitude,
+                     float* phase = nullptr);
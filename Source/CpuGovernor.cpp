@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    CpuGovernor.cpp
+    Created: 19 Oct 2026 1:05:52pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "CpuGovernor.h"
+
+#include <algorithm>
+
+#define GOVERNOR_MIN_HARMONICS  8
+#define GOVERNOR_CALM_USE       0.6f    // below this the bank may grow again...
+#define GOVERNOR_CALM_BLOCKS    50      // ...once it has stayed there this many blocks
+
+CpuGovernor::CpuGovernor() {}
+CpuGovernor::~CpuGovernor() {}
+
+void CpuGovernor::prepare(double newSampleRate, int newMaxHarmonics)
+{
+    sampleRate = newSampleRate;
+    maxHarmonics = newMaxHarmonics;
+    step = std::max(1, maxHarmonics / 10);
+    calmBlocks = 0;
+    smoothedUse = 0;
+
+    limit.store(maxHarmonics);
+    budgetUse.store(0);
+}
+
+void CpuGovernor::beginBlock()
+{
+    blockStart = std::chrono::steady_clock::now();
+}
+
+void CpuGovernor::endBlock(int numSamples)
+{
+    if (numSamples <= 0 || budget <= 0)
+        return;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - blockStart;
+    double period = numSamples / sampleRate;
+    float use = float(elapsed.count() / (period * budget));
+
+    smoothedUse = smoothedUse * 0.9f + use * 0.1f;
+    budgetUse.store(smoothedUse, std::memory_order_relaxed);
+
+    int current = limit.load(std::memory_order_relaxed);
+
+    if (! adaptive)
+    {
+        current = maxHarmonics;
+    }
+    else if (use > 1.f)
+    {
+        // over budget: back off straight away
+        current = std::max(GOVERNOR_MIN_HARMONICS, current - step);
+        calmBlocks = 0;
+    }
+    else if (smoothedUse < GOVERNOR_CALM_USE && current < maxHarmonics)
+    {
+        if (++calmBlocks >= GOVERNOR_CALM_BLOCKS)
+        {
+            current = std::min(maxHarmonics, current + step);
+            calmBlocks = 0;
+        }
+    }
+    else
+    {
+        calmBlocks = 0;
+    }
+
+    limit.store(current, std::memory_order_relaxed);
+}
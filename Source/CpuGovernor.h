@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    CpuGovernor.h
+    Created: 19 Oct 2026 1:05:52pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+/*
+    Times each block against a budget (a fraction of the block period) and
+    steps the number of harmonics the bank may run down when a block goes
+    over, and back up after a run of comfortably cheap blocks. In fixed
+    mode it still measures but never limits, which is what offline bounces
+    want.
+*/
+
+class CpuGovernor
+{
+public:
+    CpuGovernor();
+    ~CpuGovernor();
+
+    void prepare(double sampleRate, int maxHarmonics);
+
+    void setAdaptive(bool shouldAdapt) { adaptive = shouldAdapt; }
+    void setBudget(float fractionOfBlock) { budget = fractionOfBlock; }
+
+    void beginBlock();
+    void endBlock(int numSamples);
+
+    // how many bands the bank may run this block
+    int getHarmonicLimit() const { return limit.load(std::memory_order_relaxed); }
+
+    // smoothed processing time as a fraction of the budget (1 = exactly on budget)
+    float getBudgetUse() const { return budgetUse.load(std::memory_order_relaxed); }
+
+private:
+    std::chrono::steady_clock::time_point blockStart;
+
+    double sampleRate {44100.0};
+    int maxHarmonics {0};
+    int step {1};
+    int calmBlocks {0};
+    float smoothedUse {0};
+
+    bool adaptive {false};
+    float budget {0.25f};
+
+    std::atomic<int> limit {0};
+    std::atomic<float> budgetUse {0};
+};
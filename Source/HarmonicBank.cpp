@@ -0,0 +1,1222 @@
+/*
+  ==============================================================================
+
+    HarmonicBank.cpp
+    Created: 19 Oct 2026 10:02:41am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "HarmonicBank.h"
+#include "BankKernels.h"
+#include "OfflineRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+static const double pi = 3.14159265358979323846;
+
+HarmonicBank::HarmonicBank()
+    : kernels(&selectKernels())
+{
+    basePass.work.reset(new KernelWork());
+    highPass.work.reset(new KernelWork());
+}
+
+HarmonicBank::~HarmonicBank() {}
+
+const char* HarmonicBank::getKernelName() const
+{
+    return kernels->name;
+}
+
+int HarmonicBank::getNumHarmonics(int quality)
+{
+    return 50 << std::min(std::max(quality, 0), MAX_QUALITY);
+}
+
+// the harmonics the curve and the LFO spreads are laid out over
+static int getSpan(int quality)
+{
+    return std::max(MIN_SPAN, HarmonicBank::getNumHarmonics(quality));
+}
+
+int HarmonicBank::getRunningQuality() const
+{
+    return std::min(std::max(settings.quality, 0), capacityQuality);
+}
+
+int HarmonicBank::getOversamplingFactor(int oversampling)
+{
+    return 1 << std::min(std::max(oversampling, 0), 2);
+}
+
+int HarmonicBank::getOversamplingLatency(int oversampling)
+{
+    // 2x is padded out to 4x, which the offline profile may step up to
+    return oversampling > 0 ? Oversampler::getLatency(4) : 0;
+}
+
+// the setting, or 4x in place of 2x offline
+int HarmonicBank::getRunningOversampling() const
+{
+    return offline && settings.oversampling > 0 ? 2 : settings.oversampling;
+}
+
+void HarmonicBank::setOffline(bool shouldBeOffline)
+{
+    if (shouldBeOffline == offline)
+        return;
+
+    if (shouldBeOffline)
+    {
+        // hosts normally announce offline renders before prepare, which
+        // sets the renderer up then
+        if (offlineRenderer == nullptr)
+            offlineRenderer.reset(new OfflineRenderer());
+
+        if (! offlineRenderer->isPrepared() && maxBlockSize > 0)
+            offlineRenderer->prepare(maxBlockSize, capacity, offlineThreads);
+
+        offlineRenderer->loadState(bands.data(), 0, capacity);
+    }
+    else
+    {
+        offlineRenderer->storeState(bands.data(), capacity);
+    }
+
+    offline = shouldBeOffline;
+}
+
+bool HarmonicBank::isOfflineReady() const
+{
+    return offlineRenderer != nullptr && offlineRenderer->isPrepared();
+}
+
+//==============================================================================
+void HarmonicBank::prepare(double newSampleRate, int newMaxBlockSize, int newNumChannels)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // Only what the change from the last prepare invalidates is rebuilt:
+    // hosts prepare on every device change and bounce, often with nothing
+    // changed at all.
+    const bool rateChanged = newSampleRate != sampleRate || capacityQuality < 0;
+    const int quality = std::min(std::max(std::max(settings.quality, qualityCeiling), 0), MAX_QUALITY);
+
+    sampleRate = newSampleRate;
+    maxBlockSize = newMaxBlockSize;
+    numChannels = std::min(newNumChannels, MAX_CHANNELS);
+
+    // exactly the current Quality's (or the ceiling's) harmonics
+    if (quality != capacityQuality)
+    {
+        allocateHarmonics(quality, false);
+        modBank.prepare(sampleRate, capacity);
+    }
+    else if (rateChanged)
+    {
+        modBank.prepare(sampleRate, capacity);
+        governor.prepare(sampleRate, capacity);
+        coeffs = &localCoeffs;
+        sharedCoeffs = nullptr;
+        keyValid = false;
+    }
+
+    // picked here rather than per block, so an override takes effect on
+    // the next prepare; the coefficients carry the kernels' h
+    const KernelSet* selected = &selectKernels();
+
+    if (selected != kernels)
+    {
+        kernels = selected;
+        keyValid = false;
+    }
+
+    kernelNs = measureKernelThroughput(*kernels);
+
+    analyzer.prepare(sampleRate);
+
+    // Sized for 4x whatever the setting, so switching never allocates, and
+    // for the largest block and channel count seen, so a smaller block
+    // allocates nothing either.
+    if (maxBlockSize > bufferBlockSize || numChannels > bufferChannels)
+    {
+        bufferBlockSize = std::max(bufferBlockSize, maxBlockSize);
+        bufferChannels = std::max(bufferChannels, numChannels);
+
+        oversampler.prepare(bufferBlockSize, bufferChannels);
+        for (auto& line : delayLine)
+            line.assign(size_t(Oversampler::getLatency(4) + bufferBlockSize), 0.f);
+        for (auto& line : padLine)
+            line.assign(size_t(Oversampler::getLatency(4) - Oversampler::getLatency(2) + bufferBlockSize), 0.f);
+    }
+
+    // the offline renderer when offline, resized too if an earlier render made one
+    if (offline || offlineRenderer != nullptr)
+    {
+        if (offlineRenderer == nullptr)
+            offlineRenderer.reset(new OfflineRenderer());
+
+        offlineRenderer->prepare(bufferBlockSize, capacity, offlineThreads);
+    }
+
+    for (auto& band : control)
+        band = BandControl();
+
+    reset();
+    shareCoefficients();
+
+    prepareMicros.store(float(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()),
+                        std::memory_order_relaxed);
+}
+
+// Shares (or starts sharing) one copy of the coefficients with every other
+// bank at these settings. Only prepare and setPartialMap publish new sets.
+void HarmonicBank::shareCoefficients()
+{
+    updateAll();
+
+    // a set found in the cache is shared already
+    if (keyValid && ! coeffsModulated && coeffs == &localCoeffs)
+    {
+        sharedCoeffs = SharedTables::publishCoefficients(currentKey, localCoeffs);
+        coeffs = sharedCoeffs.get();
+    }
+}
+
+// n long, keeping what is there, or fresh and holding no more than n
+template <typename T>
+static void fit(std::vector<T>& array, int n, const T& value, bool keep)
+{
+    if (keep)
+        array.resize(size_t(n), value);
+    else
+        std::vector<T>(size_t(n), value).swap(array);
+}
+
+// Everything per harmonic for quality's count; with keep, the running
+// bands carry on.
+void HarmonicBank::allocateHarmonics(int quality, bool keep)
+{
+    quality = std::min(std::max(quality, 0), MAX_QUALITY);
+
+    capacityQuality = quality;
+    capacity = getNumHarmonics(quality);
+
+    fit(bands, capacity, Band(), keep);
+    fit(modValues, capacity, 0.f, keep);
+    fit(harmonicRatio, capacity, 0.f, keep);
+    fit(gainOrder, capacity, 0, keep);
+    fit(control, capacity, BandControl(), keep);
+    fit(meterEnergy, capacity, 0.f, keep);
+    fit(meterPeak, capacity, 0.f, keep);
+    fit(meterSamples, capacity, 0, keep);
+    orderDirty = true;
+    ratioDetune = -1;
+
+    // readers may still hold the old meters
+    std::atomic_store(&meters, std::make_shared<BandMeters>(capacity));
+    meteredSamples = 0;
+
+    for (auto* pass : { &basePass, &highPass })
+    {
+        pass->work->allocate(capacity);
+        fit(pass->index, capacity, 0, false);
+        pass->numWork = 0;
+    }
+
+    for (int q = 0; q <= MAX_QUALITY; q++)
+        spanTables[q] = q <= quality ? SharedTables::acquireTables(getSpan(q)) : nullptr;
+    runningQuality = -1;
+
+    // recomputed in full before the next block
+    localCoeffs.resize(capacity);
+    coeffs = &localCoeffs;
+    sharedCoeffs = nullptr;
+    keyValid = false;
+
+    governor.prepare(sampleRate, capacity);
+}
+
+void HarmonicBank::reserve(int quality)
+{
+    if (quality <= capacityQuality)
+        return;
+
+    allocateHarmonics(quality, true);
+
+    modBank.resize(capacity);
+
+    if (offlineRenderer != nullptr)
+        offlineRenderer->reserve(capacity);
+}
+
+void HarmonicBank::setPartialMap(std::shared_ptr<const PartialMap> map)
+{
+    if (map == partialMap)
+        return;
+
+    partialMap = std::move(map);
+
+    // new ratios, and everything else recomputed for the new partials
+    ratioDetune = -1;
+    keyValid = false;
+
+    if (capacity > 0)
+        shareCoefficients();
+}
+
+void HarmonicBank::reset()
+{
+    for (int i = 0; i < capacity; i++)
+    {
+        for (int chan = 0; chan < MAX_CHANNELS; chan++)
+        {
+            bands[size_t(i)].s1[chan] = 0;
+            bands[size_t(i)].s2[chan] = 0;
+        }
+
+        control[size_t(i)].culled = false;
+        control[size_t(i)].quietSamples = 0;
+    }
+
+    for (int chan = 0; chan < MAX_CHANNELS; chan++)
+    {
+        lastInput[chan] = 0;
+        std::fill(delayLine[chan].begin(), delayLine[chan].end(), 0.f);
+        std::fill(padLine[chan].begin(), padLine[chan].end(), 0.f);
+    }
+
+    if (offlineRenderer != nullptr)
+        offlineRenderer->reset();
+
+    oversamplerIdle = true;
+    analyzer.reset();
+    modBank.reset();
+
+    // the bands the next block starts with are not coming in mid-stream
+    bandsStarted = false;
+}
+
+void HarmonicBank::setSettings(const BankSettings& newSettings)
+{
+    settings = newSettings;
+
+    governor.setAdaptive(settings.governor);
+    governor.setBudget(settings.cpuBudget / 100.f);
+}
+
+//==============================================================================
+void HarmonicBank::process(float* const* channels, int numChans, int numSamples)
+{
+    process(channels, numChans, numSamples, nullptr, 0);
+}
+
+void HarmonicBank::process(float* const* channels, int numChans, int numSamples,
+                           const BankEvent* events, int numEvents)
+{
+    // before prepare there is nothing to filter with, so the audio passes
+    // through untouched; the settings still end up where the events leave them
+    if (maxBlockSize <= 0)
+    {
+        for (int i = 0; i < numEvents; i++)
+            setSettings(events[i].settings);
+
+        return;
+    }
+
+    numChans = std::min(numChans, numChannels);
+
+    int next = 0;
+
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        int end = start + std::min(maxBlockSize, numSamples - start);
+
+        // the governor times the whole chunk, however many pieces it is cut into
+        governor.beginBlock();
+
+        for (int pos = start; pos < end;)
+        {
+            while (next < numEvents && events[next].sampleOffset <= pos)
+                setSettings(events[next++].settings);
+
+            int split = next < numEvents ? std::min(end, events[next].sampleOffset) : end;
+
+            // offline, modulation moves the coefficients at the control rate
+            if (offline && (settings.modFreq || settings.modDetune))
+                split = std::min(split, pos + OFFLINE_CONTROL_SAMPLES);
+
+            float* chunk[MAX_CHANNELS];
+            for (int chan = 0; chan < numChans; chan++)
+                chunk[chan] = channels[chan] + pos;
+
+            processChunk(chunk, numChans, split - pos);
+            pos = split;
+        }
+
+        governor.endBlock(end - start);
+    }
+
+    while (next < numEvents)
+        setSettings(events[next++].settings);
+
+    publishMeters();
+}
+
+// delays the channels by latency samples through lines, which hold the last
+// latency samples of input in front
+static void delayChannels(std::vector<float>* lines, int latency, float* const* channels, int numChans, int numSamples)
+{
+    if (latency == 0)
+        return;
+
+    for (int chan = 0; chan < numChans; chan++)
+    {
+        float* line = lines[chan].data();
+
+        std::memcpy(line + latency, channels[chan], sizeof(float) * size_t(numSamples));
+        std::memcpy(channels[chan], line, sizeof(float) * size_t(numSamples));
+        std::memmove(line, line + numSamples, sizeof(float) * size_t(latency));
+    }
+}
+
+void HarmonicBank::processChunk(float* const* channels, int numChans, int numSamples)
+{
+    updateModValues(numSamples);
+    updateAll();
+    updateBandTargets(numSamples);
+    updateOversampling();
+
+    if (numChans == 0)
+        return;
+
+    // with no band below nyquist the input passes through untouched, but
+    // no sooner than it would with bands running
+    const int baseDelay = Oversampler::getLatency(runningFactor);
+    const int padDelay = runningFactor > 1 ? getOversamplingLatency(1) - baseDelay : 0;
+
+    if (numActive == 0)
+    {
+        delayChannels(delayLine, baseDelay, channels, numChans, numSamples);
+        delayChannels(padLine, padDelay, channels, numChans, numSamples);
+        return;
+    }
+
+    updateCulling(channels, numChans, numSamples);
+
+    for (int chan = 0; chan < numChans; chan++)
+        lastInput[chan] = channels[chan][numSamples - 1];
+
+    gatherBands(basePass, 1, numSamples);
+
+    highPass.numWork = 0;
+    if (runningFactor > 1)
+        gatherBands(highPass, runningFactor, numSamples * runningFactor);
+
+    // the top octave takes its copy of the input before the base-rate
+    // bands overwrite it
+    float* const* high = nullptr;
+
+    if (highPass.numWork > 0)
+    {
+        if (oversamplerIdle)
+        {
+            oversampler.reset();
+            oversamplerIdle = false;
+        }
+
+        high = oversampler.upsample(channels, numChans, numSamples, runningFactor);
+    }
+    else
+    {
+        oversamplerIdle = true;
+    }
+
+    runPass(basePass, 1, channels, numChans, numSamples);
+
+    delayChannels(delayLine, baseDelay, channels, numChans, numSamples);
+
+    if (high != nullptr)
+    {
+        runPass(highPass, runningFactor, high, numChans, numSamples * runningFactor);
+        oversampler.downsampleAdding(channels, numChans, numSamples, runningFactor);
+    }
+
+    delayChannels(padLine, padDelay, channels, numChans, numSamples);
+
+   #if THESIS_BAND_METERS
+    collectMeters(basePass, numChans);
+    collectMeters(highPass, numChans);
+   #endif
+
+    // the offline renderer keeps its own state
+    if (offline)
+    {
+        offlineRenderer->endChunk();
+        return;
+    }
+
+    scatterBands(basePass);
+    scatterBands(highPass);
+}
+
+void HarmonicBank::runPass(KernelPass& pass, int factor, float* const* channels, int numChans, int numSamples)
+{
+    if (offline)
+    {
+        offlineRenderer->run(pass, runningEngine == ENGINE_MODAL, factor, channels, numChans, numSamples);
+        return;
+    }
+
+    // kernel chosen once per block for this band count and channel count
+    int tier = getKernelTier(pass.numWork);
+
+    if (runningEngine == ENGINE_MODAL)
+        kernels->modes[tier][numChans - 1](*pass.work, channels, numSamples);
+    else
+        kernels->bands[tier][numChans - 1](*pass.work, channels, numSamples);
+}
+
+void HarmonicBank::updateOversampling()
+{
+    int factor = getOversamplingFactor(getRunningOversampling());
+
+    if (factor == runningFactor)
+        return;
+
+    // the delays change with the factor, so start them over
+    for (int chan = 0; chan < MAX_CHANNELS; chan++)
+    {
+        std::fill(delayLine[chan].begin(), delayLine[chan].end(), 0.f);
+        std::fill(padLine[chan].begin(), padLine[chan].end(), 0.f);
+    }
+
+    runningFactor = factor;
+    oversamplerIdle = true;
+}
+
+// numSamples is at the pass's own rate, for the gain ramp
+void HarmonicBank::gatherBands(KernelPass& pass, int factor, int numSamples)
+{
+    const float* g = coeffs->g.data();
+    const float* R2 = coeffs->R2.data();
+    const float* h = coeffs->h.data();
+    const float* cosR = coeffs->cosR.data();
+    const float* sinR = coeffs->sinR.data();
+    const float* drive = coeffs->drive.data();
+    const float* gain = coeffs->gain.data();
+    const int* oversample = coeffs->oversample.data();
+    bool modal = runningEngine == ENGINE_MODAL;
+    KernelWork* work = pass.work.get();
+
+    pass.numWork = 0;
+
+    for (int harm = 0; harm < numActive; harm++)
+    {
+        const BandControl& band = control[size_t(harm)];
+
+        if ((! band.on && band.fadeStart == 0.f) || band.culled || oversample[harm] != factor)
+            continue;
+
+        int k = pass.numWork++;
+
+        if (modal)
+        {
+            work->cosR[k] = cosR[harm];
+            work->sinR[k] = sinR[harm];
+            work->drive[k] = drive[harm];
+        }
+        else
+        {
+            work->g[k] = g[harm];
+            work->R2[k] = R2[harm];
+            work->h[k] = h[harm];
+        }
+
+        // linear fade from where the band was to where the governor wants it
+        work->gain[k] = gain[harm] * band.fadeStart;
+        work->gainStep[k] = gain[harm] * (band.fade - band.fadeStart) / float(numSamples);
+
+        for (int chan = 0; chan < MAX_CHANNELS; chan++)
+        {
+            work->s1[chan][k] = bands[size_t(harm)].s1[chan];
+            work->s2[chan][k] = bands[size_t(harm)].s2[chan];
+        }
+
+        pass.index[size_t(k)] = harm;
+    }
+
+   #if THESIS_BAND_METERS
+    std::fill(work->energy, work->energy + pass.numWork, 0.f);
+    std::fill(work->peak, work->peak + pass.numWork, 0.f);
+    work->meterCount = 0;
+   #endif
+
+    // pad up to the kernel tier with bands that stay silent
+    for (int k = pass.numWork; k < kernelTiers[getKernelTier(pass.numWork)]; k++)
+    {
+        work->g[k] = work->R2[k] = work->h[k] = 0;
+        work->cosR[k] = work->sinR[k] = work->drive[k] = 0;
+        work->gain[k] = work->gainStep[k] = 0;
+
+        for (int chan = 0; chan < MAX_CHANNELS; chan++)
+            work->s1[chan][k] = work->s2[chan][k] = 0;
+    }
+}
+
+void HarmonicBank::scatterBands(KernelPass& pass)
+{
+    const KernelWork* work = pass.work.get();
+
+    for (int k = 0; k < pass.numWork; k++)
+    {
+        Band& band = bands[size_t(pass.index[size_t(k)])];
+
+        for (int chan = 0; chan < MAX_CHANNELS; chan++)
+        {
+            float s1 = work->s1[chan][k];
+            float s2 = work->s2[chan][k];
+
+            // same denormal guard as StateVariableTPTFilter::snapToZero
+            band.s1[chan] = std::abs(s1) < 1.0e-8f ? 0.f : s1;
+            band.s2[chan] = std::abs(s2) < 1.0e-8f ? 0.f : s2;
+        }
+
+        // a band that has faded out starts from silence when it comes back
+        if (control[size_t(pass.index[size_t(k)])].fade == 0.f)
+            for (int chan = 0; chan < MAX_CHANNELS; chan++)
+                band.s1[chan] = band.s2[chan] = 0;
+    }
+}
+
+// what the pass's kernel metered, added to its bands' harmonics
+void HarmonicBank::collectMeters(const KernelPass& pass, int numChans)
+{
+    const KernelWork* work = pass.work.get();
+
+    if (pass.numWork == 0 || work->meterCount == 0)
+        return;
+
+    const float perChannel = 1.f / float(numChans);
+
+    for (int k = 0; k < pass.numWork; k++)
+    {
+        size_t harm = size_t(pass.index[size_t(k)]);
+
+        meterEnergy[harm] += work->energy[k] * perChannel;
+        meterPeak[harm] = std::max(meterPeak[harm], work->peak[k]);
+        meterSamples[harm] += work->meterCount;
+    }
+
+    meteredSamples += work->meterCount;
+}
+
+// Turns the sums into levels, publishes them and starts over. A band that
+// did not run reads zero. A call too short to have metered anything leaves
+// the last levels up and carries on into the next.
+void HarmonicBank::publishMeters()
+{
+    if (meteredSamples == 0)
+        return;
+
+    for (int harm = 0; harm < numActive; harm++)
+    {
+        int samples = meterSamples[size_t(harm)];
+
+        meterEnergy[size_t(harm)] = samples > 0 ? std::sqrt(meterEnergy[size_t(harm)] / float(samples)) : 0.f;
+        meterPeak[size_t(harm)] = std::sqrt(meterPeak[size_t(harm)]);
+    }
+
+    meters->publish(meterEnergy.data(), meterPeak.data(), numActive);
+
+    int follow = followBand.load(std::memory_order_relaxed);
+    followLevel.store(follow >= 0 && follow < numActive ? meterEnergy[size_t(follow)] : 0.f,
+                      std::memory_order_relaxed);
+
+    std::fill(meterEnergy.begin(), meterEnergy.end(), 0.f);
+    std::fill(meterPeak.begin(), meterPeak.end(), 0.f);
+    std::fill(meterSamples.begin(), meterSamples.end(), 0);
+    meteredSamples = 0;
+}
+
+int HarmonicBank::readBandMeters(float* rms, float* peak, int maxBands) const
+{
+    auto current = std::atomic_load(&meters);
+
+    return current != nullptr ? current->read(rms, peak, maxBands) : 0;
+}
+
+//==============================================================================
+void HarmonicBank::updateModValues(int numSamples)
+{
+    modBank.setRate(settings.modRate, settings.modRateSpread);
+    modBank.setPhaseSpread(settings.modSpread);
+    modBank.setSpan(getSpan(getRunningQuality()));
+    modBank.tick(numSamples, settings.modDepth / 100.f, modValues.data());
+
+    // offline the coefficients are targets for the end of the chunk, which
+    // the renderer ramps to from the last ones
+    if (offline)
+        modBank.read(settings.modDepth / 100.f, modValues.data());
+}
+
+// the parts of the coefficients a change from one key to the other touches
+static int getChangedParts(const CoeffKey& key, const CoeffKey& current)
+{
+    if (key.sampleRate != current.sampleRate || key.quality != current.quality
+        || key.engine != current.engine || key.oversampling != current.oversampling
+        || key.partials != current.partials)
+        return COEFF_ALL;
+
+    int parts = 0;
+
+    if (key.freq != current.freq || key.detune != current.detune)
+        parts |= COEFF_FREQ;
+    if (key.q != current.q)
+        parts |= COEFF_DAMPING | COEFF_GAIN;
+    if (key.timbre != current.timbre || key.curve != current.curve)
+        parts |= COEFF_GAIN;
+
+    return parts;
+}
+
+void HarmonicBank::updateAll()
+{
+    // the two engines read their state differently, so a switch starts from silence
+    if (settings.engine != runningEngine)
+    {
+        std::fill(bands.begin(), bands.end(), Band());
+        if (offlineRenderer != nullptr)
+            offlineRenderer->reset();
+        runningEngine = settings.engine;
+        keyValid = false;
+    }
+
+    // Only what the change touches is recomputed: automating timbre redoes
+    // the gains, modulation only the frequencies. Modulated coefficients
+    // change every block, so they are never shared.
+    bool modulated = settings.modFreq || settings.modDetune;
+    CoeffKey key = makeKey();
+
+    if (key.quality != runningQuality)
+    {
+        runningQuality = key.quality;
+        tables = spanTables[runningQuality].get();
+    }
+
+    if (settings.detune != ratioDetune)
+        updateHarmonicRatios();
+    int parts = keyValid ? getChangedParts(key, currentKey) : COEFF_ALL;
+
+    if (modulated || coeffsModulated)
+        parts |= COEFF_FREQ;
+
+    if (parts != 0)
+    {
+        orderDirty = true;
+
+        auto shared = modulated ? nullptr : SharedTables::findCoefficients(key, false);
+
+        if (shared != nullptr)
+        {
+            sharedCoeffs = shared;
+            coeffs = sharedCoeffs.get();
+        }
+        else
+        {
+            // a shared set at this Quality has no more bands than localCoeffs
+            if (parts != COEFF_ALL && coeffs != &localCoeffs)
+                localCoeffs.copyActive(*coeffs);
+
+            computeCoefficients(localCoeffs, parts);
+            coeffs = &localCoeffs;
+        }
+
+        currentKey = key;
+        keyValid = true;
+        coeffsModulated = modulated;
+    }
+
+    const int wasActive = numActive;
+    numActive = coeffs->numActive;
+
+    if (bandsStarted && numActive > wasActive)
+        warmBands(wasActive, numActive);
+
+    bandsStarted = true;
+}
+
+// Bands coming in mid-stream, from a higher Quality or a lower fundamental,
+// would otherwise step in at full gain from whatever state they were left
+// with. They start settled on the input instead, as culled bands wake (see
+// updateCulling), and fade in over GOVERNOR_FADE_SECONDS.
+void HarmonicBank::warmBands(int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        BandControl& band = control[size_t(i)];
+
+        band.fade = band.fadeStart = 0.f;
+        band.culled = false;
+        band.quietSamples = 0;
+
+        for (int chan = 0; chan < MAX_CHANNELS; chan++)
+        {
+            bands[size_t(i)].s1[chan] = 0;
+            bands[size_t(i)].s2[chan] = runningEngine == ENGINE_SVF ? lastInput[chan] : 0.f;
+        }
+    }
+
+    if (offline)
+        offlineRenderer->loadState(bands.data(), begin, end);
+}
+
+std::shared_ptr<const CoeffSet> HarmonicBank::computeCoefficientSet(const BankSettings& newSettings, double newSampleRate,
+                                                                    std::shared_ptr<const PartialMap> map)
+{
+    HarmonicBank bank;
+
+    bank.settings = newSettings;
+    bank.settings.modFreq = false;
+    bank.settings.modDetune = false;
+    bank.sampleRate = newSampleRate;
+    bank.capacityQuality = MAX_QUALITY;
+    bank.partialMap = std::move(map);
+
+    auto shared = SharedTables::findCoefficients(bank.makeKey(), true);
+
+    if (shared != nullptr)
+        return shared;
+
+    int quality = bank.getRunningQuality();
+    auto set = std::make_shared<CoeffSet>();
+    set->resize(getNumHarmonics(quality));
+
+    auto tables = SharedTables::acquireTables(getSpan(quality));
+    bank.tables = tables.get();
+    bank.capacity = getNumHarmonics(quality);
+    bank.harmonicRatio.resize(size_t(bank.capacity));
+    bank.updateHarmonicRatios();
+    bank.computeCoefficients(*set, COEFF_ALL);
+
+    return set;
+}
+
+void HarmonicBank::computeCoefficients(CoeffSet& out, int parts) const
+{
+    typedef void (HarmonicBank::*CoeffUpdate)(CoeffSet&, int) const;
+
+    // [modFreq][modDetune], chosen once per update
+    static const CoeffUpdate updates[2][2] = {
+        { &HarmonicBank::computeCoefficientsFor<false, false>, &HarmonicBank::computeCoefficientsFor<false, true> },
+        { &HarmonicBank::computeCoefficientsFor<true, false>,  &HarmonicBank::computeCoefficientsFor<true, true>  },
+    };
+
+    (this->*updates[settings.modFreq][settings.modDetune])(out, parts);
+}
+
+// Anything short of COEFF_ALL updates out in place, so out must hold the
+// coefficients for the previous settings. Bands that were silent or not
+// active then get everything.
+template <bool ModFreq, bool ModDetune>
+void HarmonicBank::computeCoefficientsFor(CoeffSet& out, int parts) const
+{
+    int numHarm = getNumHarmonics(getRunningQuality());
+    if (partialMap != nullptr)
+        numHarm = std::min(numHarm, partialMap->getNumPartials());
+
+    // log(Q multiplier) per band: the map's, or (h / 2 + 1) for the harmonics
+    const float* logQScale = partialMap != nullptr ? partialMap->getLogQScales() : tables->logQScale.data();
+    float nyquist = float(sampleRate) / 2.f;
+    float logQ = std::log(settings.q);
+    bool modal = settings.engine == ENGINE_MODAL;
+    int factor = getOversamplingFactor(getRunningOversampling());
+
+    // with the frequencies unchanged no band can come into range or leave it
+    int wasActive = parts == COEFF_ALL ? 0 : out.numActive;
+    int count = (parts & COEFF_FREQ) != 0 ? numHarm : wasActive;
+
+    out.numActive = 0;
+    out.engine = settings.engine;
+
+    for (int i = 0; i < count; i++)
+    {
+        // silent bands are marked by R2 = 0
+        bool wasLive = i < wasActive && out.R2[size_t(i)] != 0.f;
+        int todo = wasLive ? parts : COEFF_ALL;
+
+        float freq = 0;
+
+        if ((todo & COEFF_FREQ) != 0 || (modal && (todo & COEFF_DAMPING) != 0))
+        {
+            freq = getCurFreq<ModFreq, ModDetune>(i);
+
+            if (freq >= nyquist)
+                break;
+
+            freq = wrap(freq, int(sampleRate));
+
+            if (freq < 20.f || freq >= nyquist)
+            {
+                // out of range after wrapping: keep the band silent
+                out.gain[size_t(i)] = 0.f;
+                out.R2[size_t(i)] = 0.f;
+                out.oversample[size_t(i)] = 1;
+                out.numActive++;
+                continue;
+            }
+        }
+
+        // q = settings.q * (i / 2 + 1), normGain = (1 / q) ^ 0.8
+        float logBandQ = logQ + logQScale[i];
+
+        if ((todo & COEFF_DAMPING) != 0)
+            out.R2[size_t(i)] = std::exp(-logBandQ);
+
+        if ((todo & COEFF_FREQ) != 0)
+        {
+            // the top octave runs at the oversampled rate when there is one
+            int bandFactor = freq >= nyquist * OVERSAMPLE_SPLIT ? factor : 1;
+
+            out.g[size_t(i)] = tables->tanWarp(freq, sampleRate * bandFactor);
+            out.octave[size_t(i)] = OctaveAnalyzer::getOctave(freq, sampleRate);
+            out.oversample[size_t(i)] = bandFactor;
+        }
+
+        if (modal && (todo & (COEFF_FREQ | COEFF_DAMPING)) != 0)
+        {
+            // pole r e^(j theta) with r = exp(-pi B / fs), B = fc / q, and
+            // drive 2 (1 - r) q so the peak matches the SVF's q
+            double bandRate = sampleRate * out.oversample[size_t(i)];
+            float R2 = out.R2[size_t(i)];
+            double theta = 2.0 * pi * freq / bandRate;
+            double decay = pi * freq * R2 / bandRate;
+            double r = std::exp(-decay);
+
+            out.cosR[size_t(i)] = float(r * std::cos(theta));
+            out.sinR[size_t(i)] = float(r * std::sin(theta));
+            out.drive[size_t(i)] = float(-2.0 * std::expm1(-decay) / R2);
+        }
+
+        if ((todo & COEFF_GAIN) != 0)
+            out.gain[size_t(i)] = getBandGain(i, logBandQ);
+
+        out.numActive++;
+    }
+
+    // h for every band at once, in the selected kernels' instruction set
+    kernels->updateH(out.g.data(), out.R2.data(), out.h.data(), out.numActive);
+}
+
+float HarmonicBank::getBandGain(int harm, float logBandQ) const
+{
+    // a map brings its own spectrum, so Curve and Timbre stand aside
+    if (partialMap != nullptr)
+        return partialMap->getGains()[harm] * std::exp(-0.8f * logBandQ);
+
+    float curveGain = std::exp(tables->logCurve[size_t(harm)] * (1.f / settings.curve) - 0.8f * logBandQ);
+    float oddEvenGain = harm == 0 ? 1.f : (harm % 2 == 1 ? 1.f - settings.timbre : settings.timbre);
+
+    return curveGain * oddEvenGain;
+}
+
+void HarmonicBank::updateGainOrder()
+{
+    const float* gain = coeffs->gain.data();
+
+    for (int i = 0; i < numActive; i++)
+        gainOrder[size_t(i)] = i;
+
+    std::sort(gainOrder.begin(), gainOrder.begin() + numActive, [gain](int a, int b)
+    {
+        return std::abs(gain[a]) > std::abs(gain[b]);
+    });
+
+    orderDirty = false;
+}
+
+void HarmonicBank::updateBandTargets(int numSamples)
+{
+    // offline renders every band
+    int limit = offline ? capacity : governor.getHarmonicLimit();
+
+    if (limit < numActive && orderDirty)
+        updateGainOrder();
+
+    // only the loudest `limit` bands stay on
+    if (limit >= numActive)
+    {
+        for (int i = 0; i < numActive; i++)
+            control[size_t(i)].on = true;
+    }
+    else
+    {
+        for (int rank = 0; rank < numActive; rank++)
+            control[size_t(gainOrder[size_t(rank)])].on = rank < limit;
+    }
+
+    float fadeStep = float(numSamples / (GOVERNOR_FADE_SECONDS * sampleRate));
+
+    for (int i = 0; i < numActive; i++)
+    {
+        BandControl& band = control[size_t(i)];
+
+        band.fadeStart = band.fade;
+
+        if (band.on)
+            band.fade = std::min(1.f, band.fade + fadeStep);
+        else
+            band.fade = std::max(0.f, band.fade - fadeStep);
+    }
+}
+
+void HarmonicBank::updateCulling(const float* const* channels, int numChans, int numSamples)
+{
+    // with few bands running, the analysis costs more than culling them all saves
+    if (! settings.culling || offline || numActive < CULL_MIN_BANDS)
+    {
+        if (cullingActive)
+        {
+            for (auto& band : control)
+            {
+                band.culled = false;
+                band.quietSamples = 0;
+            }
+            analyzer.reset();
+            cullingActive = false;
+        }
+
+        culledBands.store(0, std::memory_order_relaxed);
+        averageCulled.store(0, std::memory_order_relaxed);
+        return;
+    }
+
+    cullingActive = true;
+    analyzer.analyse(channels, numChans, numSamples);
+
+    const int holdSamples = int(CULL_HOLD_SECONDS * sampleRate);
+
+    // Input power each octave's bands see: the octave itself and its
+    // neighbours near the peak, everything further out through the skirt,
+    // which is where a bass line reaches the upper bands. The SVF skirt
+    // falls 6 dB per octave; the modal one levels off (see below).
+    const bool modal = runningEngine == ENGINE_MODAL;
+    float nearPower[ANALYZER_OCTAVES], skirtLevel[ANALYZER_OCTAVES];
+    float inputPower = 0;
+    for (int o = 0; o < ANALYZER_OCTAVES; o++)
+    {
+        inputPower += analyzer.getPower(o);
+        nearPower[o] = 0;
+        float skirtPower = 0;
+
+        for (int j = 0; j < ANALYZER_OCTAVES; j++)
+        {
+            int distance = std::abs(j - o);
+
+            if (distance <= 1)
+                nearPower[o] += analyzer.getPower(j);
+            else
+                skirtPower += modal ? analyzer.getPower(j) : analyzer.getPower(j) / float(1 << (2 * distance));
+        }
+
+        // the skirt adds as amplitude (below); taken once per octave, not per band
+        skirtLevel[o] = std::sqrt(skirtPower);
+    }
+
+    // The bands share one error budget, handed out from the highest
+    // (quietest) band down. What they drop near their peaks and in their
+    // ringing lies at different frequencies and adds as power; the skirt
+    // leakage is the same bass in every band and adds as amplitude. It also
+    // sits where the input is loud, so the budget grows with the input.
+    const float budget = CULL_FLOOR + CULL_RELATIVE * inputPower;
+    const float wakeBudget = budget * CULL_HYSTERESIS;
+    float spentSkirt = 0, spentPower = 0;
+    int numCulled = 0;
+
+    for (int i = numActive - 1; i >= 0; i--)
+    {
+        BandControl& band = control[size_t(i)];
+        Band& state = bands[size_t(i)];
+        float gain = coeffs->gain[size_t(i)];
+        int octave = coeffs->octave[size_t(i)];
+
+        // the band peaks at q = 1 / R2 before its gain; silent bands may
+        // carry no R2 at all
+        float peak = gain != 0.f ? gain / coeffs->R2[size_t(i)] : 0.f;
+        float skirt = skirtLevel[octave] * std::abs(gain);
+
+        // re(z) of the resonator keeps drive (1 -+ r cos) / |1 -+ p|^2 far
+        // below and above its peak
+        if (modal)
+        {
+            float c = coeffs->cosR[size_t(i)];
+            float s = coeffs->sinR[size_t(i)];
+            float below = (1.f - c) / ((1.f - c) * (1.f - c) + s * s);
+            float above = (1.f + c) / ((1.f + c) * (1.f + c) + s * s);
+
+            skirt *= coeffs->drive[size_t(i)] * std::max(below, above);
+        }
+        float power = nearPower[octave] * peak * peak;
+
+        if (band.culled)
+        {
+            float error = (spentSkirt + skirt) * (spentSkirt + skirt) + spentPower + power;
+
+            if (error > wakeBudget)
+            {
+                band.culled = false;
+                band.quietSamples = 0;
+
+                // A quiet SVF band still carries whatever lies below it in its
+                // low-pass integrator (s2 follows the input), so it wakes
+                // settled on the input rather than stepping from zero.
+                for (int chan = 0; chan < MAX_CHANNELS; chan++)
+                {
+                    state.s1[chan] = 0;
+                    state.s2[chan] = runningEngine == ENGINE_SVF ? lastInput[chan] : 0.f;
+                }
+            }
+        }
+        else
+        {
+            // only the band-pass part of the state counts; see above for s2
+            float ringing = 0;
+            for (int chan = 0; chan < numChans; chan++)
+            {
+                ringing += state.s1[chan] * state.s1[chan];
+                if (runningEngine == ENGINE_MODAL)
+                    ringing += state.s2[chan] * state.s2[chan];
+            }
+
+            power += ringing * gain * gain;
+
+            float error = (spentSkirt + skirt) * (spentSkirt + skirt) + spentPower + power;
+
+            if (error <= budget)
+            {
+                band.quietSamples += numSamples;
+
+                // what is left of the state is far below audibility
+                if (band.quietSamples >= holdSamples)
+                {
+                    band.culled = true;
+
+                    for (int chan = 0; chan < MAX_CHANNELS; chan++)
+                        state.s1[chan] = state.s2[chan] = 0;
+                }
+            }
+            else
+            {
+                band.quietSamples = 0;
+            }
+        }
+
+        if (band.culled)
+        {
+            spentSkirt += skirt;
+            spentPower += power;
+            numCulled++;
+        }
+    }
+
+    float smoothed = averageCulled.load(std::memory_order_relaxed) * 0.9f + float(numCulled) * 0.1f;
+
+    culledBands.store(numCulled, std::memory_order_relaxed);
+    averageCulled.store(smoothed, std::memory_order_relaxed);
+}
+
+CoeffKey HarmonicBank::makeKey() const
+{
+    CoeffKey key;
+
+    key.sampleRate = sampleRate;
+    key.freq = settings.freq;
+    key.q = settings.q;
+    key.curve = settings.curve;
+    key.detune = settings.detune;
+    key.timbre = settings.timbre;
+    key.quality = getRunningQuality();
+    key.engine = settings.engine;
+    key.oversampling = getOversamplingFactor(getRunningOversampling());
+    key.partials = partialMap != nullptr ? partialMap->getId() : 0;
+
+    return key;
+}
+
+template <bool ModFreq, bool ModDetune>
+float HarmonicBank::getCurFreq(int harm) const
+{
+    float fc, detune, freqModVal;
+
+    fc = settings.freq;
+
+    freqModVal = ModFreq ? modValues[harm] : 0.f;
+
+    if (! ModDetune)
+        return (freqModVal + 1.f) * fc * harmonicRatio[harm];
+
+    if (harm > 0)
+    {
+        detune = settings.detune;
+
+        if (ModDetune)
+            detune += (modValues[harm] / 200.f);
+    }
+    else
+        detune = 1;
+
+    detune = detune == 0 ? 0.1f : detune;
+
+    if (partialMap != nullptr)
+        return (freqModVal + 1.f) * fc * std::exp(detune * partialMap->getLogRatios()[harm]);
+
+    return (freqModVal + 1.f) * fc * std::pow(float(harm + 1), detune);
+}
+
+// (harm + 1) ^ detune at rest, so frequency automation and modulation need
+// no pow per band; a map's ratio ^ detune comes from the logs it took at load
+void HarmonicBank::updateHarmonicRatios()
+{
+    if (partialMap != nullptr)
+    {
+        const int numPartials = std::min(capacity, partialMap->getNumPartials());
+        const float* ratios = partialMap->getRatios();
+        const float* logRatios = partialMap->getLogRatios();
+        const float detune = settings.detune == 0 ? 0.1f : settings.detune;
+
+        // the first partial stays put, as the fundamental does
+        harmonicRatio[0] = ratios[0];
+
+        for (int i = 1; i < numPartials; i++)
+            harmonicRatio[size_t(i)] = detune == 1.f ? ratios[i] : std::exp(detune * logRatios[i]);
+
+        ratioDetune = settings.detune;
+        return;
+    }
+
+    for (int harm = 0; harm < capacity; harm++)
+    {
+        float detune = harm > 0 ? settings.detune : 1.f;
+        detune = detune == 0 ? 0.1f : detune;
+
+        harmonicRatio[size_t(harm)] = std::pow(float(harm + 1), detune);
+    }
+
+    ratioDetune = settings.detune;
+}
+
+float HarmonicBank::wrap(float x, int fs) const
+{
+    if (x > fs / 2)
+        return x - int(std::ceil(x)) % fs;
+
+    if (x < 20)
+        return 20 - x + 20;
+
+    return x;
+}
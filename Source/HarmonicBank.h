@@ -0,0 +1,376 @@
+/*
+  ==============================================================================
+
+    HarmonicBank.h
+    Created: 19 Oct 2026 10:02:41am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "BandMeters.h"
+#include "CpuGovernor.h"
+#include "OctaveAnalyzer.h"
+#include "Oversampler.h"
+#include "ModBank.h"
+#include "PartialMap.h"
+#include "SharedTables.h"
+
+#define MAX_QUALITY     5
+#define MAX_HARM        (50 << MAX_QUALITY)     // harmonics at the highest Quality
+#define MIN_SPAN        200     // the curve and the LFO spreads span at least the original bank's harmonics
+#define MAX_CHANNELS    2
+
+#define GOVERNOR_FADE_SECONDS   0.01
+
+#define CULL_FLOOR          1e-11f      // output power all culled bands may drop together (-110 dB)
+#define CULL_RELATIVE       1e-7f       // plus this much of the input power (-70 dB)
+#define CULL_HYSTERESIS     4.f         // culled bands may use this much more before they wake
+#define CULL_HOLD_SECONDS   0.05        // and are only culled after staying quiet this long
+#define CULL_MIN_BANDS      32          // fewer bands than this run unculled (see updateCulling)
+
+#define OVERSAMPLE_SPLIT    0.5f    // bands above this fraction of nyquist run oversampled
+
+#define OFFLINE_CONTROL_SAMPLES 32  // offline, modulated coefficients are recomputed this often and ramped in between
+
+// what a settings change makes the coefficient update redo
+#define COEFF_FREQ      1       // g, octave, oversampling, modal pole
+#define COEFF_DAMPING   2       // R2, modal pole and drive
+#define COEFF_GAIN      4
+#define COEFF_ALL       (COEFF_FREQ | COEFF_DAMPING | COEFF_GAIN)
+
+#define ENGINE_SVF      0
+#define ENGINE_MODAL    1
+
+/*
+    The harmonic band-pass bank on its own, with no JUCE, plugin or GUI
+    dependency, so it can be embedded outside the plugin (see ThesisDSP.h
+    for the C API). Each band is a TPT state-variable band-pass filter,
+    matching juce::dsp::StateVariableTPTFilter, followed by the curve and
+    odd/even gains folded into a single multiply.
+
+    The modal engine swaps each band for a complex one-pole resonator (a
+    decaying rotating phasor) with the same centre, bandwidth and peak
+    gain; see BankKernels.h.
+
+    With oversampling on, the bands in the top octave (above
+    OVERSAMPLE_SPLIT of nyquist), where the TPT warping squeezes their
+    bandwidth hardest, run at 2x or 4x the rate on an upsampled copy of the
+    input (see Oversampler.h); everything below stays at the base rate and
+    is delayed to line up with them. Only the filters and the few top bands
+    pay for the higher rate, and the delay is getLatencySamples.
+
+    Quality sets the number of harmonics: 50, doubling per step up to
+    MAX_HARM, for low fundamentals at high sample rates. Everything kept per
+    harmonic is sized by prepare for exactly the current Quality's count,
+    split into what the kernels touch every sample (KernelWork, packed per
+    block, and the band states) and the per-block bookkeeping (BandControl).
+
+    A PartialMap (setPartialMap) replaces the harmonic series with loaded
+    partials: its ratios, raised to Detune like the harmonics, its gains in
+    place of Curve and Timbre, and its Q multipliers in place of the Q that
+    grows with the harmonic number. Quality still caps how many run.
+
+    For bounces there is an offline profile (setOffline) that trades CPU
+    for accuracy; see OfflineRenderer.h.
+
+    Each band's output level is metered as it runs and published at the end
+    of every process call (readBandMeters, and getFollowLevel for one band);
+    see BandMeters.h.
+*/
+
+struct BankSettings
+{
+    /* Main Section */
+    float timbre {0};
+    float freq {0};
+    float q {0};
+
+    /* Secondary Section */
+    float stereoLink {0};
+    int quality {0};            // 50 << quality harmonics
+    float curve {0};
+    float detune {0};
+    int oversampling {0};       // top octave at 1x, 2x or 4x (0, 1, 2)
+
+    /* Mod Section */
+    bool modFreq {0};
+    bool modDetune {0};
+    float modRate {0};
+    float modDepth {0};
+    float modSpread {0};        // LFO phase offset across the harmonics, in cycles
+    float modRateSpread {0};    // top harmonic's LFO runs this much faster than the fundamental's
+
+    /* CPU Section */
+    bool governor {0};
+    float cpuBudget {0};        // percent of the block period
+    bool culling {0};           // skip bands with no input energy near them
+    int engine {ENGINE_SVF};
+};
+
+// settings that take effect sampleOffset samples into a process call
+struct BankEvent
+{
+    int sampleOffset {0};
+    BankSettings settings;
+};
+
+typedef struct {
+    float s1[MAX_CHANNELS];     // SVF integrators, or the modal phasor's re...
+    float s2[MAX_CHANNELS];     // ...and im
+} Band;
+
+// what the governor and culling keep per band, read once per block
+struct BandControl
+{
+    float fade {1.f};           // governor fade, where it ends this block...
+    float fadeStart {1.f};      // ...and where it started
+    int quietSamples {0};       // culling: how long the band has been quiet
+    bool on {true};             // the governor wants it running
+    bool culled {false};
+};
+
+struct KernelWork;
+struct KernelSet;
+class OfflineRenderer;
+
+// the bands one kernel call runs, packed (see BankKernels.h)
+struct KernelPass
+{
+    std::unique_ptr<KernelWork> work;
+    std::vector<int> index;
+    int numWork {0};
+};
+
+class HarmonicBank
+{
+public:
+    HarmonicBank();
+    ~HarmonicBank();
+
+    // Rebuilds only what the change from the last prepare invalidates: at
+    // the same sample rate and Quality the coefficients and per-harmonic
+    // arrays stay as they are, and the buffers only ever grow with the
+    // block size and channel count. The filters start from silence either way.
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    void reset();
+
+    // microseconds the last prepare took; any thread
+    float getPrepareMicros() const { return prepareMicros.load(std::memory_order_relaxed); }
+
+    void setSettings(const BankSettings& newSettings);
+    const BankSettings& getSettings() const { return settings; }
+
+    // harmonics at a Quality setting
+    static int getNumHarmonics(int quality);
+
+    // Harmonics there is room for: prepare makes room for the current
+    // Quality's, or the ceiling's if that is higher, and until reserve
+    // makes more a higher Quality runs at the highest there is room for.
+    // reserve keeps the running bands' state, but allocates, so call it
+    // between process calls and never on the audio thread. A caller whose
+    // Quality can move during playback sets the ceiling to the highest it
+    // reaches, so no change ever has to wait for room.
+    int getHarmonicCapacity() const { return capacity; }
+    void reserve(int quality);
+    void setQualityCeiling(int quality) { qualityCeiling = quality; }
+
+    // Partials to run in place of the harmonic series, or nullptr for the
+    // harmonics. Releasing the old map may unmap it, so like reserve this
+    // belongs between process calls and off the audio thread.
+    void setPartialMap(std::shared_ptr<const PartialMap> map);
+    const std::shared_ptr<const PartialMap>& getPartialMap() const { return partialMap; }
+
+    // filters the channels in place; channels beyond the prepared count, and
+    // every channel before the first prepare, are left untouched
+    void process(float* const* channels, int numChannels, int numSamples);
+
+    // The same with sample-accurate settings changes: the block is split at
+    // each event (in order of sampleOffset), only the coefficients the
+    // change touches are recomputed there, and the spans in between run
+    // the usual kernels. Events at or past numSamples apply at the end.
+    void process(float* const* channels, int numChannels, int numSamples,
+                 const BankEvent* events, int numEvents);
+
+    int getNumActiveHarmonics() const { return numActive; }
+
+    // The RMS and peak of each band's output over the last process call
+    // that metered any, fundamental first (see BandMeters.h); any thread.
+    // Returns how many bands were running.
+    int readBandMeters(float* rms, float* peak, int maxBands) const;
+
+    // the last process call's RMS of one band (0 is the fundamental), for
+    // an envelope follower; both calls are safe from any thread
+    void setFollowBand(int harm) { followBand.store(harm, std::memory_order_relaxed); }
+    float getFollowLevel() const { return followLevel.load(std::memory_order_relaxed); }
+
+    // The offline profile, for renders with no deadline: modulated
+    // coefficients are recomputed every OFFLINE_CONTROL_SAMPLES and ramped
+    // every sample in between, the bands run in double precision on every
+    // core, oversampling (when on) runs at 4x, and the governor and culling
+    // stand aside. The latency is the same in both profiles, so a bounce
+    // lines up with playback. Switch between blocks; the first switch to
+    // offline starts the worker threads unless prepare already did.
+    void setOffline(bool shouldBeOffline);
+    bool isOffline() const { return offline; }
+
+    // Whether the worker threads are up, which a prepare while offline sees
+    // to; then switching either way only copies the band states, and the
+    // audio thread may do it.
+    bool isOfflineReady() const;
+    
+    // Caps the offline profile at maxThreads counting the caller, for
+    // callers that already run a bank per core; 0 (the default) uses every
+    // core. Only counts before the worker threads start.
+    void setOfflineThreads(int maxThreads) { offlineThreads = maxThreads; }
+
+    // samples the output trails the input by; only oversampling adds any,
+    // and the same at 2x and 4x so the offline profile can step up
+    int getLatencySamples() const { return getOversamplingLatency(settings.oversampling); }
+    static int getOversamplingLatency(int oversampling);
+    static int getOversamplingFactor(int oversampling);
+
+    // harmonics the governor currently lets run, and its smoothed budget use
+    int getGovernorHarmonics() const { return governor.getHarmonicLimit(); }
+    float getGovernorBudgetUse() const { return governor.getBudgetUse(); }
+
+    // the kernel variant prepare picked (see BankKernels.h) and its measured
+    // nanoseconds per band-sample
+    const char* getKernelName() const;
+    float getKernelThroughput() const { return kernelNs; }
+
+    // bands skipped for lack of input energy: last block, and smoothed
+    int getNumCulledBands() const { return culledBands.load(std::memory_order_relaxed); }
+    float getAverageCulledBands() const { return averageCulled.load(std::memory_order_relaxed); }
+
+    // the coefficients a bank would run for these settings with modulation
+    // at rest, shared if another bank already has them (see BankResponse.h)
+    static std::shared_ptr<const CoeffSet> computeCoefficientSet(const BankSettings& settings, double sampleRate,
+                                                                 std::shared_ptr<const PartialMap> map = nullptr);
+
+private:
+    void processChunk(float* const* channels, int numChannels, int numSamples);
+    void gatherBands(KernelPass& pass, int factor, int numSamples);
+    void scatterBands(KernelPass& pass);
+    void collectMeters(const KernelPass& pass, int numChannels);
+    void publishMeters();
+    void runPass(KernelPass& pass, int factor, float* const* channels, int numChannels, int numSamples);
+    void updateOversampling();
+    int getRunningOversampling() const;
+    int getRunningQuality() const;
+    void allocateHarmonics(int quality, bool keep);
+    void updateModValues(int numSamples);
+    void updateAll();
+    void warmBands(int begin, int end);
+    void shareCoefficients();
+    void computeCoefficients(CoeffSet& out, int parts) const;
+
+    template <bool ModFreq, bool ModDetune>
+    void computeCoefficientsFor(CoeffSet& out, int parts) const;
+    float getBandGain(int harm, float logBandQ) const;
+    void updateGainOrder();
+    void updateBandTargets(int numSamples);
+    void updateCulling(const float* const* channels, int numChannels, int numSamples);
+    CoeffKey makeKey() const;
+
+    template <bool ModFreq, bool ModDetune>
+    float getCurFreq(int harm) const;
+    void updateHarmonicRatios();
+    float wrap(float x, int sampleRate) const;
+
+    BankSettings settings;
+    ModBank modBank;
+
+    // per harmonic, capacity long: the state the kernels carry from block
+    // to block, and what the coefficient update reads
+    int capacity {0};
+    int capacityQuality {-1};
+    int qualityCeiling {-1};    // prepare allocates for at least this Quality
+    std::vector<Band> bands;
+    std::vector<float> modValues;
+    std::vector<float> harmonicRatio;
+    float ratioDetune {-1};
+    std::shared_ptr<const PartialMap> partialMap;
+
+    // the tables for each Quality up to the capacity (the curve's span
+    // differs above MIN_SPAN), and the ones the current Quality uses
+    std::shared_ptr<const BankTables> spanTables[MAX_QUALITY + 1];
+    const BankTables* tables {nullptr};
+    int runningQuality {-1};
+
+    // coeffs points at either the shared set for the current settings or,
+    // while modulating or before a shared set exists, at localCoeffs
+    std::shared_ptr<const CoeffSet> sharedCoeffs;
+    CoeffSet localCoeffs;
+    const CoeffSet* coeffs {nullptr};
+    CoeffKey currentKey;
+    bool keyValid {false};
+    bool coeffsModulated {false};
+    int runningEngine {ENGINE_SVF};
+
+    // false until the first block after a reset, whose bands are not
+    // coming in mid-stream (see warmBands)
+    bool bandsStarted {false};
+
+    // The governor switches bands off quietest first (gainOrder), fading
+    // each one over GOVERNOR_FADE_SECONDS rather than cutting it.
+    CpuGovernor governor;
+    bool orderDirty {true};
+    std::vector<int> gainOrder;
+    std::vector<BandControl> control;
+
+    // Bands with no input energy near them (OctaveAnalyzer) and no ringing
+    // left are culled after CULL_HOLD_SECONDS and wake as soon as energy returns.
+    OctaveAnalyzer analyzer;
+    float lastInput[MAX_CHANNELS] {};
+    bool cullingActive {false};
+    std::atomic<int> culledBands {0};
+    std::atomic<float> averageCulled {0};
+
+    // the bands running this block, packed for the kernel (see BankKernels.h):
+    // at the base rate, and the top octave at runningFactor times it
+    const KernelSet* kernels {nullptr};
+    float kernelNs {0};
+    KernelPass basePass, highPass;
+
+    // The oversampler is left alone while no band needs it and starts from
+    // silence when one does; the base-rate bands always go through the
+    // delay while oversampling is on, so the latency never changes under
+    // the host. At 2x the whole output is padded out to the 4x latency.
+    Oversampler oversampler;
+    std::vector<float> delayLine[MAX_CHANNELS];
+    std::vector<float> padLine[MAX_CHANNELS];
+    int runningFactor {1};
+    bool oversamplerIdle {true};
+
+    // what the oversampler and the delays are sized for: the most prepare has seen
+    int bufferBlockSize {0};
+    int bufferChannels {0};
+
+    // what the kernels metered since the last publish, per harmonic: mean
+    // square output per channel, summed over the metered samples, the
+    // largest squared envelope and how many samples were metered
+    std::vector<float> meterEnergy;
+    std::vector<float> meterPeak;
+    std::vector<int> meterSamples;
+    int meteredSamples {0};
+    std::shared_ptr<BandMeters> meters;     // replaced only by allocateHarmonics
+    std::atomic<int> followBand {0};
+    std::atomic<float> followLevel {0};
+
+    // the offline profile's band loop, created the first time it is needed
+    std::unique_ptr<OfflineRenderer> offlineRenderer;
+    bool offline {false};
+    int offlineThreads {0};
+
+    double sampleRate {44100.0};
+    std::atomic<float> prepareMicros {0};
+    int maxBlockSize {0};
+    int numChannels {0};
+    int numActive {0};
+};
@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    ModBank.cpp
+    Created: 20 Oct 2026 9:31:04am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "ModBank.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double twoPi = 6.283185307179586476925;
+
+ModBank::ModBank() {}
+ModBank::~ModBank() {}
+
+void ModBank::prepare(double newSampleRate, int newNumOscillators)
+{
+    sampleRate = newSampleRate;
+    span = newNumOscillators;
+
+    resize(newNumOscillators);
+    reset();
+}
+
+void ModBank::resize(int newNumOscillators)
+{
+    const int wasRunning = getNumRunning();
+
+    numOscillators = newNumOscillators;
+
+    re.resize(size_t(numOscillators), 1.f);
+    im.resize(size_t(numOscillators), 0.f);
+    rotRe.assign(size_t(MODBANK_LEVELS * numOscillators), 1.f);
+    rotIm.assign(size_t(MODBANK_LEVELS * numOscillators), 0.f);
+
+    // the ones there were run on; only those new to it start from basePhase
+    seed(wasRunning, getNumRunning());
+    rotationDirty = true;
+}
+
+void ModBank::setSpan(int newSpan)
+{
+    if (newSpan == span)
+        return;
+
+    const int wasRunning = getNumRunning();
+
+    span = newSpan;
+
+    seed(wasRunning, getNumRunning());
+    retarget();
+    rotationDirty = true;
+}
+
+void ModBank::reset()
+{
+    basePhase = 0;
+    needsReseed = true;
+}
+
+void ModBank::setRate(float rateHz, float newRateSpread)
+{
+    if (rateHz == rate && newRateSpread == rateSpread)
+        return;
+
+    // the phasors carry on from where they are, only their rotation changes
+    rate = rateHz;
+    rateSpread = newRateSpread;
+    rotationDirty = true;
+}
+
+void ModBank::setPhaseSpread(float spread)
+{
+    if (spread != phaseSpread)
+    {
+        phaseSpread = spread;
+        retarget();
+    }
+}
+
+//==============================================================================
+void ModBank::tick(int numSamples, float depth, float *out)
+{
+    if (needsReseed)
+    {
+        // from a reset the offsets start where they belong
+        offset = targetOffset = span > 0 ? double(phaseSpread) / span : 0.0;
+        glideRemaining = 0;
+        rotationDirty = true;
+
+        seed(0, getNumRunning());
+        needsReseed = false;
+    }
+
+    read(depth, out);
+
+    // a glide ends on its own sample, and the rotation without it takes over
+    for (int done = 0; done < numSamples;)
+    {
+        int length = numSamples - done;
+
+        if (glideRemaining > 0)
+            length = std::min(length, glideRemaining);
+
+        if (rotationDirty)
+            updateRotation();
+
+        advance(length);
+        done += length;
+
+        if (glideRemaining > 0)
+        {
+            glideRemaining -= length;
+            offset += glideStep * length;
+
+            if (glideRemaining == 0)
+            {
+                offset = targetOffset;
+                rotationDirty = true;
+            }
+        }
+    }
+
+    basePhase = std::fmod(basePhase + twoPi * rate * numSamples / sampleRate, twoPi);
+}
+
+void ModBank::read(float depth, float *out) const
+{
+    for (int i = 0; i < getNumRunning(); i++)
+        out[i] = depth * im[size_t(i)];
+}
+
+void ModBank::seed(int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        double phase = basePhase + twoPi * offset * i;
+
+        re[size_t(i)] = float(std::cos(phase));
+        im[size_t(i)] = float(std::sin(phase));
+    }
+}
+
+// heads for the offsets the spread and span ask for, from wherever they are
+void ModBank::retarget()
+{
+    targetOffset = span > 0 ? double(phaseSpread) / span : 0.0;
+
+    if (needsReseed)
+        return;
+
+    // already there: the ticks stay whole, and exactly as with no spread
+    if (targetOffset == offset)
+    {
+        if (glideRemaining > 0)
+        {
+            glideRemaining = 0;
+            rotationDirty = true;
+        }
+
+        return;
+    }
+
+    glideRemaining = std::max(1, int(MODBANK_GLIDE_SECONDS * sampleRate));
+    glideStep = (targetOffset - offset) / glideRemaining;
+    rotationDirty = true;
+}
+
+// numSamples in one go: the levels its binary digits pick, top down
+void ModBank::advance(int numSamples)
+{
+    float *pr = re.data(), *pi = im.data();
+    const int numRunning = getNumRunning();
+
+    for (int level = MODBANK_LEVELS - 1; level >= 0 && numSamples > 0; level--)
+    {
+        const int levelSamples = 1 << level;
+
+        // anything past the top level takes it more than once
+        while (numSamples >= levelSamples)
+        {
+            const float *cr = rotRe.data() + size_t(level * numOscillators);
+            const float *ci = rotIm.data() + size_t(level * numOscillators);
+
+            for (int i = 0; i < numRunning; i++)
+            {
+                float r = pr[i] * cr[i] - pi[i] * ci[i];
+                float m = pr[i] * ci[i] + pi[i] * cr[i];
+
+                pr[i] = r;
+                pi[i] = m;
+            }
+
+            numSamples -= levelSamples;
+        }
+    }
+
+    // one Newton step back towards |z| = 1 keeps rounding from drifting the amplitude
+    for (int i = 0; i < numRunning; i++)
+    {
+        float norm = 1.5f - 0.5f * (pr[i] * pr[i] + pi[i] * pi[i]);
+
+        pr[i] *= norm;
+        pi[i] *= norm;
+    }
+}
+
+void ModBank::updateRotation()
+{
+    const double step = glideRemaining > 0 ? glideStep : 0.0;
+
+    for (int i = 0; i < getNumRunning(); i++)
+    {
+        // a glide moves each offset at a steady pace, which is a change of rate
+        double scale = double(i) / span;
+        double inc = twoPi * (rate * (1.0 + rateSpread * scale) / sampleRate + step * i);
+        double cr = std::cos(inc), ci = std::sin(inc);
+
+        // and squared up the levels in double, so the long ones keep their accuracy
+        for (int level = 0; level < MODBANK_LEVELS; level++)
+        {
+            rotRe[size_t(level * numOscillators + i)] = float(cr);
+            rotIm[size_t(level * numOscillators + i)] = float(ci);
+
+            double r = cr * cr - ci * ci;
+            ci = 2.0 * cr * ci;
+            cr = r;
+        }
+    }
+
+    rotationDirty = false;
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    ModBank.h
+    Created: 20 Oct 2026 9:31:04am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+#define MODBANK_LEVELS          13      // rotations kept for 1, 2, 4 .. 4096 samples
+#define MODBANK_GLIDE_SECONDS   0.05    // phase spread changes glide over this long
+
+/*
+    One LFO per harmonic, all advanced together once per control tick (one
+    bank block). Each oscillator is a unit phasor kept as separate re/im
+    arrays. Its rotation over 1, 2, 4 .. 2^(MODBANK_LEVELS - 1) samples is
+    worked out whenever the rate or the spreads change, and a tick turns it
+    by the levels that add up to its length: a few branch-free complex
+    multiplies across all harmonics, with no sin() calls however the bank
+    splits its blocks.
+
+    Harmonic h sits phaseSpread * 2pi * h / N ahead of the fundamental and
+    runs at rate * (1 + rateSpread * h / N). N is the span, by default the
+    number of oscillators, so spreads of zero give every harmonic the same
+    LFO. A change of phase spread or span glides the offsets to their new
+    place over MODBANK_GLIDE_SECONDS, by running each harmonic that much
+    faster or slower, rather than stepping them there.
+*/
+
+class ModBank
+{
+public:
+    ModBank();
+    ~ModBank();
+
+    void prepare(double sampleRate, int numOscillators);
+    void reset();
+
+    // more or fewer oscillators, carrying on from the current phase
+    void resize(int numOscillators);
+
+    // the N the spreads are laid out over; only the first N oscillators
+    // run, so a bank with room for more pays nothing for them
+    void setSpan(int span);
+
+    void setRate(float rateHz, float rateSpread);
+    void setPhaseSpread(float spread);
+
+    // writes depth * sin(phase) for every running oscillator, then advances them all by numSamples
+    void tick(int numSamples, float depth, float *out);
+
+    // depth * sin(phase) where the last tick left them, i.e. what the next tick writes
+    void read(float depth, float *out) const;
+
+private:
+    int getNumRunning() const { return span < numOscillators ? span : numOscillators; }
+    void seed(int begin, int end);
+    void retarget();
+    void advance(int numSamples);
+    void updateRotation();
+
+    std::vector<float> re, im;          // phasor per oscillator
+    std::vector<float> rotRe, rotIm;    // rotation per oscillator over 2^level samples, level by level
+
+    double sampleRate {44100.0};
+    double basePhase {0};
+    int numOscillators {0};
+    int span {0};
+
+    float rate {0};
+    float rateSpread {0};
+    float phaseSpread {0};
+    bool needsReseed {true};
+    bool rotationDirty {true};
+
+    // how far each oscillator sits ahead of the one below, in cycles, and
+    // where a glide is taking that
+    double offset {0};
+    double targetOffset {0};
+    double glideStep {0};               // per sample
+    int glideRemaining {0};
+};
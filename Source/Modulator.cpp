@@ -10,6 +10,8 @@
 
 #include "Modulator.h"
 
+static const float twoPi = 6.283185307179586476925f;
+
 Modulator::Modulator() {}
 Modulator::~Modulator() {}
 
@@ -28,7 +30,7 @@ void Modulator::setMod(float in_freq) {
     } else {
         fs = this->samp_rate;
         f0 = in_freq;
-        mod.phase_inc = juce::MathConstants<float>::twoPi * f0 / fs;
+        mod.phase_inc = twoPi * f0 / fs;
     }
 }
 
@@ -42,7 +44,7 @@ void Modulator::updateMod(float new_freq) {
     } else {
         fs = this->samp_rate;
         f0  =new_freq;
-        mod.phase_inc  =juce::MathConstants<float>::twoPi * f0 / fs;
+        mod.phase_inc  =twoPi * f0 / fs;
     }
 }
 
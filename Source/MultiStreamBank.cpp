@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    MultiStreamBank.cpp
+    Created: 25 Oct 2026 2:37:50pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "MultiStreamBank.h"
+
+#include <algorithm>
+
+MultiStreamBank::MultiStreamBank() {}
+
+MultiStreamBank::~MultiStreamBank() {}
+
+void MultiStreamBank::prepare(double newSampleRate, int newMaxBlockSize, int newNumStreams, int newNumChannels,
+                              int numThreads)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = std::max(newMaxBlockSize, 1);
+    numStreams = std::max(newNumStreams, 0);
+    numChannels = std::min(std::max(newNumChannels, 1), MAX_CHANNELS);
+    numLanes = (numStreams * numChannels + STREAM_TILE - 1) / STREAM_TILE * STREAM_TILE;
+
+    kernels = &selectKernels();
+
+    input.assign(size_t(maxBlockSize) * size_t(numLanes), 0.f);
+    output.assign(size_t(maxBlockSize) * size_t(numLanes), 0.f);
+
+    // the state is laid out by numLanes, so none of it carries over
+    state1.clear();
+    state2.clear();
+    running.clear();
+    bands.clear();
+    bands.reserve(MAX_HARM);
+
+    pool.start(std::max(numThreads, 1) - 1);
+
+    // the rate may have changed; allocate here rather than on the first block
+    coeffsDirty = true;
+    updateCoefficients();
+}
+
+void MultiStreamBank::reset()
+{
+    std::fill(state1.begin(), state1.end(), 0.f);
+    std::fill(state2.begin(), state2.end(), 0.f);
+}
+
+void MultiStreamBank::setSettings(const BankSettings& newSettings)
+{
+    settings = newSettings;
+    coeffsDirty = true;
+}
+
+void MultiStreamBank::setPartialMap(std::shared_ptr<const PartialMap> map)
+{
+    partialMap = std::move(map);
+    coeffsDirty = true;
+}
+
+void MultiStreamBank::updateCoefficients()
+{
+    if (! coeffsDirty || numLanes == 0)
+        return;
+
+    coeffsDirty = false;
+
+    // every band at the base rate, see the class comment
+    BankSettings rest = settings;
+    rest.oversampling = 0;
+
+    coeffs = HarmonicBank::computeCoefficientSet(rest, sampleRate, partialMap);
+
+    // the engines keep different things in the same state, so switching
+    // starts every band over from silence
+    if (coeffs->engine != runningEngine)
+    {
+        runningEngine = coeffs->engine;
+        std::fill(running.begin(), running.end(), 0);
+    }
+
+    const int numActive = coeffs->numActive;
+
+    if (int(running.size()) < numActive)
+    {
+        running.resize(size_t(numActive), 0);
+        state1.resize(size_t(numActive) * size_t(numLanes), 0.f);
+        state2.resize(size_t(numActive) * size_t(numLanes), 0.f);
+    }
+
+    bands.clear();
+
+    for (int harm = 0; harm < int(running.size()); harm++)
+    {
+        const bool live = harm < numActive && coeffs->gain[size_t(harm)] != 0.f;
+
+        if (live && ! running[size_t(harm)])
+        {
+            auto first = size_t(harm) * size_t(numLanes);
+
+            std::fill(state1.begin() + long(first), state1.begin() + long(first + size_t(numLanes)), 0.f);
+            std::fill(state2.begin() + long(first), state2.begin() + long(first + size_t(numLanes)), 0.f);
+        }
+
+        running[size_t(harm)] = live;
+
+        if (live)
+            bands.push_back(harm);
+    }
+
+    work.g = coeffs->g.data();
+    work.R2 = coeffs->R2.data();
+    work.h = coeffs->h.data();
+    work.cosR = coeffs->cosR.data();
+    work.sinR = coeffs->sinR.data();
+    work.drive = coeffs->drive.data();
+    work.gain = coeffs->gain.data();
+    work.bands = bands.data();
+    work.numBands = int(bands.size());
+    work.s1 = state1.data();
+    work.s2 = state2.data();
+    work.numLanes = numLanes;
+}
+
+void MultiStreamBank::runTile(void* context, int index)
+{
+    auto& bank = *static_cast<MultiStreamBank*>(context);
+    const size_t offset = size_t(index) * size_t(STREAM_TILE) * size_t(bank.maxBlockSize);
+
+    StreamKernel kernel = bank.runningEngine == ENGINE_MODAL ? bank.kernels->streamModes
+                                                             : bank.kernels->streamBands;
+
+    kernel(bank.work, bank.input.data() + offset, bank.output.data() + offset, index * STREAM_TILE,
+           bank.blockSamples);
+}
+
+void MultiStreamBank::process(float* const* channels, int numSamples)
+{
+    updateCoefficients();
+
+    // with no band below nyquist the input passes through, as in HarmonicBank
+    if (numLanes == 0 || coeffs == nullptr || coeffs->numActive == 0)
+        return;
+
+    const int numSignals = numStreams * numChannels;
+
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+    {
+        blockSamples = std::min(maxBlockSize, numSamples - start);
+
+        for (int lane = 0; lane < numSignals; lane++)
+        {
+            const float* in = channels[lane] + start;
+            float* x = input.data() + size_t(lane / STREAM_TILE) * size_t(STREAM_TILE) * size_t(maxBlockSize)
+                                    + size_t(lane % STREAM_TILE);
+
+            for (int n = 0; n < blockSamples; n++)
+                x[n * STREAM_TILE] = in[n];
+        }
+
+        pool.run(&MultiStreamBank::runTile, this, numLanes / STREAM_TILE);
+
+        for (int lane = 0; lane < numSignals; lane++)
+        {
+            float* out = channels[lane] + start;
+            const float* y = output.data() + size_t(lane / STREAM_TILE) * size_t(STREAM_TILE) * size_t(maxBlockSize)
+                                           + size_t(lane % STREAM_TILE);
+
+            for (int n = 0; n < blockSamples; n++)
+                out[n] = y[n * STREAM_TILE];
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    MultiStreamBank.h
+    Created: 25 Oct 2026 2:37:50pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "HarmonicBank.h"
+#include "BankKernels.h"
+#include "WorkerPool.h"
+
+/*
+    One set of bands over many independent signals at once, for dataset and
+    stem jobs that run the same settings over dozens or hundreds of them.
+
+    Every stream shares one coefficient set, the one computeCoefficientSet
+    makes and every bank at the same settings shares. Each channel of each
+    stream is a lane, and the stream kernels (see BankKernels.h) run a band
+    over a tile of lanes at a time: the vectors run across the streams
+    rather than across the bands, so each band's coefficients are loaded
+    once per tile and chunk instead of once per stream and sample.
+
+    What a HarmonicBank does per instance and per block is left out: the
+    modulation sits at rest, every band runs (no governor, culling or
+    metering), there is no oversampling, so no latency either, and a band
+    that comes in starts from silence rather than fading in warm. Apart
+    from that each stream comes out as a HarmonicBank would filter it, to
+    within float rounding, as the bands are summed in another order.
+*/
+
+class MultiStreamBank
+{
+public:
+    MultiStreamBank();
+    ~MultiStreamBank();
+
+    // numStreams signals of numChannels (1 or 2) each. With numThreads
+    // above 1 the tiles are spread over a WorkerPool, which is for renders
+    // without a deadline only.
+    void prepare(double sampleRate, int maxBlockSize, int numStreams, int numChannels, int numThreads = 1);
+    void reset();
+
+    // The coefficients are looked up, or computed, on the next process
+    // call, which allocates unless another bank already has them; for the
+    // jobs this is for, that is between blocks and off any audio thread.
+    void setSettings(const BankSettings& newSettings);
+    const BankSettings& getSettings() const { return settings; }
+
+    // partials in place of the harmonic series (see HarmonicBank::setPartialMap)
+    void setPartialMap(std::shared_ptr<const PartialMap> map);
+
+    // filters channels[stream * numChannels + chan] for every stream in place
+    void process(float* const* channels, int numSamples);
+
+    int getNumStreams() const { return numStreams; }
+    int getNumChannels() const { return numChannels; }
+    int getNumActiveHarmonics() const { return coeffs != nullptr ? coeffs->numActive : 0; }
+
+private:
+    void updateCoefficients();
+    static void runTile(void* context, int index);
+
+    BankSettings settings;
+    std::shared_ptr<const PartialMap> partialMap;
+    std::shared_ptr<const CoeffSet> coeffs;
+    bool coeffsDirty {true};
+    int runningEngine {ENGINE_SVF};
+
+    const KernelSet* kernels {nullptr};
+    StreamWork work;
+
+    // the harmonics with any gain, and for each harmonic whether it ran in
+    // the last block: one coming in starts from silence
+    std::vector<int> bands;
+    std::vector<char> running;
+
+    // per harmonic, numLanes each
+    std::vector<float> state1, state2;
+
+    // one block, tile after tile, each tile's lanes STREAM_TILE to a sample
+    // (what the stream kernels take); the lanes past the last stream's stay
+    // silent
+    std::vector<float> input, output;
+    int blockSamples {0};
+
+    WorkerPool pool;
+
+    double sampleRate {44100.0};
+    int maxBlockSize {0};
+    int numStreams {0};
+    int numChannels {0};
+    int numLanes {0};
+};
@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    OctaveAnalyzer.cpp
+    Created: 20 Oct 2026 6:18:52pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "OctaveAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// two-path polyphase half-band (elliptic, transition band 0.1 of fs),
+// three first-order allpasses per path
+static const float pathA[ANALYZER_ALLPASSES] = { 0.039151597734460045f, 0.3026468483284934f, 0.6746159185469639f };
+static const float pathB[ANALYZER_ALLPASSES] = { 0.1473771136010466f, 0.48246854276970014f, 0.8830050257693731f };
+
+OctaveAnalyzer::OctaveAnalyzer()
+{
+    reset();
+}
+
+OctaveAnalyzer::~OctaveAnalyzer() {}
+
+void OctaveAnalyzer::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void OctaveAnalyzer::reset()
+{
+    std::memset(splits, 0, sizeof(splits));
+    std::memset(energy, 0, sizeof(energy));
+    std::memset(power, 0, sizeof(power));
+}
+
+static inline float allpass(float x, float coeff, float& lastIn, float& lastOut)
+{
+    float y = coeff * (x - lastOut) + lastIn;
+
+    lastIn = x;
+    lastOut = y;
+
+    return y;
+}
+
+// same denormal guard as HarmonicBank::scatterBands; the states otherwise
+// decay into denormals through every rest in the input
+static inline void snapToZero(float& state)
+{
+    state = std::abs(state) < 1.0e-8f ? 0.f : state;
+}
+
+int OctaveAnalyzer::splitLevel(Split& split, const float* input, int numInput, float* low, float& highEnergy)
+{
+    // the allpass states are copied in and out once per run, not per pair
+    float evenIn[ANALYZER_ALLPASSES], evenOut[ANALYZER_ALLPASSES];
+    float oddIn[ANALYZER_ALLPASSES], oddOut[ANALYZER_ALLPASSES];
+
+    std::memcpy(evenIn, split.evenIn, sizeof(evenIn));
+    std::memcpy(evenOut, split.evenOut, sizeof(evenOut));
+    std::memcpy(oddIn, split.oddIn, sizeof(oddIn));
+    std::memcpy(oddOut, split.oddOut, sizeof(oddOut));
+
+    int numLow = 0, n = 0;
+    float energy = 0;
+
+    auto pair = [&] (float a, float b)
+    {
+        for (int i = 0; i < ANALYZER_ALLPASSES; i++)
+        {
+            a = allpass(a, pathA[i], evenIn[i], evenOut[i]);
+            b = allpass(b, pathB[i], oddIn[i], oddOut[i]);
+        }
+
+        float high = (a - b) * 0.5f;
+        energy += high * high;
+
+        // written behind where it reads, so low may be the input
+        low[numLow++] = (a + b) * 0.5f;
+    };
+
+    // a sample left over from the last run pairs with the first of this one
+    if (split.hasPending && numInput > 0)
+    {
+        pair(input[0], split.pending);
+        split.hasPending = false;
+        n = 1;
+    }
+
+    for (; n + 1 < numInput; n += 2)
+        pair(input[n + 1], input[n]);
+
+    if (n < numInput)
+    {
+        split.pending = input[n];
+        split.hasPending = true;
+    }
+
+    std::memcpy(split.evenIn, evenIn, sizeof(evenIn));
+    std::memcpy(split.evenOut, evenOut, sizeof(evenOut));
+    std::memcpy(split.oddIn, oddIn, sizeof(oddIn));
+    std::memcpy(split.oddOut, oddOut, sizeof(oddOut));
+    highEnergy = energy;
+
+    return numLow;
+}
+
+void OctaveAnalyzer::analyse(const float* const* channels, int numChannels, int numSamples)
+{
+    std::memset(energy, 0, sizeof(energy));
+
+    numChannels = std::min(numChannels, ANALYZER_CHANNELS);
+
+    // The tree runs a level at a time over runs of the block rather than a
+    // sample at a time down the whole tree: each level's recursion then
+    // pipelines from one pair to the next, with no branch per sample.
+    float low[ANALYZER_RUN / 2];
+
+    for (int chan = 0; chan < numChannels; chan++)
+    {
+        Split* levels = splits[chan];
+
+        for (int start = 0; start < numSamples; start += ANALYZER_RUN)
+        {
+            const float* input = channels[chan] + start;
+            int numInput = std::min(ANALYZER_RUN, numSamples - start);
+
+            for (int k = 0; k < ANALYZER_OCTAVES && numInput > 0; k++)
+            {
+                float highEnergy = 0;
+                numInput = splitLevel(levels[k], input, numInput, low, highEnergy);
+                input = low;
+
+                // each output sample at level k stands for 2^(k + 1) input samples
+                energy[k] += float(2 << k) * highEnergy;
+
+                if (k == ANALYZER_OCTAVES - 1)
+                    for (int n = 0; n < numInput; n++)
+                        energy[k] += (1 << ANALYZER_OCTAVES) * low[n] * low[n];
+            }
+        }
+
+        for (auto& split : splits[chan])
+        {
+            for (int i = 0; i < ANALYZER_ALLPASSES; i++)
+            {
+                snapToZero(split.evenIn[i]);
+                snapToZero(split.evenOut[i]);
+                snapToZero(split.oddIn[i]);
+                snapToZero(split.oddOut[i]);
+            }
+
+            snapToZero(split.pending);
+        }
+    }
+
+    if (numSamples <= 0)
+        return;
+
+    float release = float(std::exp(-numSamples / (ANALYZER_RELEASE_SECONDS * sampleRate)));
+
+    for (int k = 0; k < ANALYZER_OCTAVES; k++)
+        power[k] = std::max(energy[k] / float(numSamples), power[k] * release);
+}
+
+int OctaveAnalyzer::getOctave(float freq, double sampleRate)
+{
+    if (freq <= 0)
+        return ANALYZER_OCTAVES - 1;
+
+    // floor(log2(x)) straight from the exponent
+    int exponent = 0;
+    std::frexp(sampleRate / (2.0 * freq), &exponent);
+    int octave = exponent - 1;
+
+    return std::min(std::max(octave, 0), ANALYZER_OCTAVES - 1);
+}
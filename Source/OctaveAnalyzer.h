@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    OctaveAnalyzer.h
+    Created: 20 Oct 2026 6:18:52pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#define ANALYZER_OCTAVES    10
+#define ANALYZER_CHANNELS   2
+#define ANALYZER_ALLPASSES  3       // per path of each half-band split
+#define ANALYZER_RELEASE_SECONDS    0.05
+#define ANALYZER_RUN        256     // input samples each level of the tree runs over at a time
+
+/*
+    A coarse octave filterbank for the bank's input: a dyadic tree of
+    polyphase IIR half-band splits (three first-order allpasses per path),
+    so each level halves the rate and the whole tree costs a few operations
+    per input sample. Octave 0 covers fs/4 .. fs/2, octave 1 fs/8 .. fs/4
+    and so on; the last octave also collects everything below it.
+
+    The splits are power complementary, so the powers add up to the input
+    power, and they reject the other half by roughly 100 dB, which is what
+    lets the bank tell a bass line from silence ten octaves up.
+
+    The deep octaves only see a handful of samples per block, so the
+    reported power holds its peak and falls back over
+    ANALYZER_RELEASE_SECONDS rather than following each block.
+*/
+
+class OctaveAnalyzer
+{
+public:
+    OctaveAnalyzer();
+    ~OctaveAnalyzer();
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // mean power per octave of everything the channels carry this block,
+    // held as above
+    void analyse(const float* const* channels, int numChannels, int numSamples);
+    float getPower(int octave) const { return power[octave]; }
+
+    static int getOctave(float freq, double sampleRate);
+
+private:
+    struct Split
+    {
+        float evenIn[ANALYZER_ALLPASSES], evenOut[ANALYZER_ALLPASSES];  // path A allpass states
+        float oddIn[ANALYZER_ALLPASSES], oddOut[ANALYZER_ALLPASSES];    // path B allpass states
+        float pending {0};
+        bool hasPending {false};
+    };
+
+    static int splitLevel(Split& split, const float* input, int numInput, float* low, float& highEnergy);
+
+    Split splits[ANALYZER_CHANNELS][ANALYZER_OCTAVES];
+    float energy[ANALYZER_OCTAVES];
+    float power[ANALYZER_OCTAVES];
+
+    double sampleRate {44100.0};
+};
@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 22 Oct 2026 10:41:09am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "BankKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+OfflineRenderer::OfflineRenderer() {}
+
+OfflineRenderer::~OfflineRenderer() {}
+
+void OfflineRenderer::prepare(int maxBlockSize, int numHarmonics, int maxThreads)
+{
+    states.assign(size_t(numHarmonics), BandState());
+
+    if (! isPrepared())
+    {
+        int numThreads = int(std::thread::hardware_concurrency());
+
+        if (maxThreads > 0)
+            numThreads = std::min(numThreads, maxThreads);
+
+        pool.start(std::max(numThreads, 1) - 1);
+    }
+
+    if (4 * maxBlockSize > maxSamples)
+    {
+        maxSamples = 4 * maxBlockSize;
+        sums.assign(size_t(pool.getNumThreads() * MAX_CHANNELS * maxSamples), 0.0);
+    }
+
+    reset();
+}
+
+void OfflineRenderer::reserve(int numHarmonics)
+{
+    BandState silent = BandState();
+    silent.lastChunk = -1;
+
+    if (numHarmonics > int(states.size()))
+        states.resize(size_t(numHarmonics), silent);
+}
+
+void OfflineRenderer::reset()
+{
+    // silent, with nothing to ramp from
+    BandState silent = BandState();
+    silent.lastChunk = -1;
+
+    std::fill(states.begin(), states.end(), silent);
+
+    chunk = 1;
+}
+
+void OfflineRenderer::loadState(const Band* bands, int begin, int end)
+{
+    for (int i = begin; i < std::min(end, int(states.size())); i++)
+    {
+        for (int chan = 0; chan < MAX_CHANNELS; chan++)
+        {
+            states[i].s1[chan] = bands[i].s1[chan];
+            states[i].s2[chan] = bands[i].s2[chan];
+        }
+
+        states[i].lastChunk = -1;
+    }
+}
+
+void OfflineRenderer::storeState(Band* bands, int numBands) const
+{
+    for (int i = 0; i < std::min(numBands, int(states.size())); i++)
+    {
+        for (int chan = 0; chan < MAX_CHANNELS; chan++)
+        {
+            bands[i].s1[chan] = float(states[i].s1[chan]);
+            bands[i].s2[chan] = float(states[i].s2[chan]);
+        }
+    }
+}
+
+//==============================================================================
+void OfflineRenderer::run(const KernelPass& newPass, bool newModal, int newFactor,
+                          float* const* channels, int newNumChans, int newNumSamples)
+{
+    pass = &newPass;
+    modal = newModal;
+    factor = newFactor;
+    input = channels;
+    numChans = newNumChans;
+    numSamples = std::min(newNumSamples, maxSamples);
+
+    // at least OFFLINE_MIN_BANDS per thread
+    numJobs = std::min(pool.getNumThreads(), (pass->numWork + OFFLINE_MIN_BANDS - 1) / OFFLINE_MIN_BANDS);
+    numJobs = std::max(numJobs, 1);
+
+    pool.run(&OfflineRenderer::runJob, this, numJobs);
+
+   #if THESIS_BAND_METERS
+    pass->work->meterCount = numSamples;
+   #endif
+
+    // in job order, so the sum is the same however the threads were scheduled
+    for (int chan = 0; chan < numChans; chan++)
+    {
+        for (int n = 0; n < numSamples; n++)
+        {
+            double sum = 0;
+
+            for (int job = 0; job < numJobs; job++)
+                sum += sums[size_t((job * MAX_CHANNELS + chan) * maxSamples + n)];
+
+            channels[chan][n] = float(sum);
+        }
+    }
+}
+
+void OfflineRenderer::runJob(void* context, int index)
+{
+    auto* renderer = static_cast<OfflineRenderer*>(context);
+    const int numWork = renderer->pass->numWork;
+    const int numJobs = renderer->numJobs;
+
+    renderer->runBands(numWork * index / numJobs, numWork * (index + 1) / numJobs,
+                       &renderer->sums[size_t(index * MAX_CHANNELS * renderer->maxSamples)]);
+}
+
+void OfflineRenderer::runBands(int begin, int end, double* jobSums)
+{
+    for (int chan = 0; chan < numChans; chan++)
+        std::fill(jobSums + chan * maxSamples, jobSums + chan * maxSamples + numSamples, 0.0);
+
+    for (int k = begin; k < end; k++)
+    {
+        if (modal)
+            runBand<true>(k, jobSums);
+        else
+            runBand<false>(k, jobSums);
+    }
+}
+
+template <bool Modal>
+void OfflineRenderer::runBand(int k, double* jobSums)
+{
+    const KernelWork& work = *pass->work;
+    BandState& state = states[size_t(pass->index[size_t(k)])];
+
+    const double g = work.g[k], R2 = work.R2[k];
+    const double cosR = work.cosR[k], sinR = work.sinR[k], drive = work.drive[k];
+
+    // a band that did not run last chunk, or ran at another rate, has
+    // nothing meaningful to ramp from
+    if (state.lastChunk != chunk - 1 || state.factor != factor)
+    {
+        state.g = g;
+        state.R2 = R2;
+        state.cosR = cosR;
+        state.sinR = sinR;
+        state.drive = drive;
+        state.factor = factor;
+    }
+
+    const double scale = 1.0 / numSamples;
+    const double dg = (g - state.g) * scale, dR2 = (R2 - state.R2) * scale;
+    const double dCos = (cosR - state.cosR) * scale, dSin = (sinR - state.sinR) * scale;
+    const double dDrive = (drive - state.drive) * scale;
+    const double gain = work.gain[k], gainStep = work.gainStep[k];
+
+   #if THESIS_BAND_METERS
+    // every sample is metered here, so exactly
+    double energy = 0;
+    double peak = 0;
+   #endif
+
+    for (int chan = 0; chan < numChans; chan++)
+    {
+        const float* x = input[chan];
+        double* out = jobSums + chan * maxSamples;
+        double s1 = state.s1[chan], s2 = state.s2[chan];
+
+        for (int n = 0; n < numSamples; n++)
+        {
+            // the coefficients land on the targets at the last sample
+            const double t = n + 1;
+            double y, quadrature;
+
+            if (Modal)
+            {
+                double c = state.cosR + dCos * t;
+                double s = state.sinR + dSin * t;
+                double re = c * s1 - s * s2 + (state.drive + dDrive * t) * x[n];
+
+                s2 = s * s1 + c * s2;
+                s1 = re;
+                y = re;
+                quadrature = s2;
+            }
+            else
+            {
+                double gn = state.g + dg * t;
+                double R2n = state.R2 + dR2 * t;
+                double yHP = (x[n] - s1 * (gn + R2n) - s2) / (1.0 + R2n * gn + gn * gn);
+
+                double yBP = yHP * gn + s1;
+                s1 = yHP * gn + yBP;
+
+                double yLP = yBP * gn + s2;
+                s2 = yBP * gn + yLP;
+                y = yBP;
+                quadrature = yLP;
+            }
+
+            const double level = gain + gainStep * n;
+
+           #if THESIS_BAND_METERS
+            // the exact mean square, and the peak of the envelope like the
+            // kernels (see meterBand)
+            energy += y * y * (level * level);
+            peak = std::max(peak, (y * y + quadrature * quadrature) * (level * level));
+           #else
+            (void) quadrature;
+           #endif
+
+            out[n] += y * level;
+        }
+
+        state.s1[chan] = std::abs(s1) < OFFLINE_SNAP ? 0.0 : s1;
+        state.s2[chan] = std::abs(s2) < OFFLINE_SNAP ? 0.0 : s2;
+    }
+
+    state.g = g;
+    state.R2 = R2;
+    state.cosR = cosR;
+    state.sinR = sinR;
+    state.drive = drive;
+    state.lastChunk = chunk;
+
+   #if THESIS_BAND_METERS
+    pass->work->energy[k] = float(energy);
+    pass->work->peak[k] = float(peak);
+   #endif
+}
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 22 Oct 2026 10:41:09am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include "HarmonicBank.h"
+#include "WorkerPool.h"
+
+#define OFFLINE_MIN_BANDS   8           // fewer bands per thread than this are not worth waking it for
+#define OFFLINE_SNAP        1.0e-20     // state below this is flushed to zero
+
+/*
+    The bank's band loop for the offline profile (see HarmonicBank::setOffline):
+    the same filters as the kernels in BankKernels.h, but with double state
+    and arithmetic, coefficients that ramp every sample from where each band
+    was at the end of the last chunk to the targets the bank gathered for
+    this one, and the bands split across every core.
+
+    Each thread sums its own share of the bands into its own buffer and the
+    calling thread adds those up, so the result does not depend on how the
+    bands were split or which thread finished first.
+*/
+
+class OfflineRenderer
+{
+public:
+    OfflineRenderer();
+    ~OfflineRenderer();
+
+    // starts a helper per spare core, or enough for maxThreads counting the
+    // caller, and sizes the per-thread sums for chunks of up to
+    // 4 maxBlockSize (the oversampled rate); the helpers carry on and the
+    // sums only grow when it is called again
+    void prepare(int maxBlockSize, int numHarmonics, int maxThreads = 0);
+    bool isPrepared() const { return maxSamples > 0; }
+
+    // room for more bands, keeping the ones there are
+    void reserve(int numHarmonics);
+
+    void reset();
+
+    // the band states, over from and back to the float engine when the
+    // profile switches; loadState takes bands [begin, end)
+    void loadState(const Band* bands, int begin, int end);
+    void storeState(Band* bands, int numBands) const;
+
+    // Runs the pass's bands over numSamples at factor times the base rate,
+    // ramping from their last coefficients to the ones in the pass, and
+    // replaces the channels with the sum, like the kernels do. The bands
+    // are metered into the pass's KernelWork on every sample.
+    void run(const KernelPass& pass, bool modal, int factor, float* const* channels, int numChannels, int numSamples);
+
+    // after both passes of a chunk; bands that sat this one out start their
+    // next ramp at the target
+    void endChunk() { chunk++; }
+
+    int getNumThreads() const { return pool.getNumThreads(); }
+
+private:
+    struct BandState
+    {
+        double s1[MAX_CHANNELS];
+        double s2[MAX_CHANNELS];
+        double g, R2, cosR, sinR, drive;    // where the last ramp ended
+        int factor;
+        int lastChunk;
+    };
+
+    static void runJob(void* context, int index);
+    void runBands(int begin, int end, double* sums);
+
+    template <bool Modal>
+    void runBand(int k, double* sums);
+
+    std::vector<BandState> states;
+    int chunk {0};
+
+    WorkerPool pool;
+    std::vector<double> sums;           // per job: MAX_CHANNELS x maxSamples
+    int maxSamples {0};
+
+    // the current run, for the jobs
+    const KernelPass* pass {nullptr};
+    bool modal {false};
+    int factor {1};
+    const float* const* input {nullptr};
+    int numChans {0};
+    int numSamples {0};
+    int numJobs {0};
+};
@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    Oversampler.cpp
+    Created: 21 Oct 2026 4:05:51pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "Oversampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define KAISER_BETA     10.0
+
+static const double pi = 3.14159265358979323846;
+
+// modified Bessel function of the first kind, order 0
+static double besselI0(double x)
+{
+    double sum = 1, term = 1;
+
+    for (int k = 1; k < 50 && term > 1.0e-12 * sum; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+//==============================================================================
+void HalfbandStage::design(int newHalfOrder)
+{
+    halfOrder = newHalfOrder;
+    historyLength = 2 * halfOrder + 1;
+
+    // h[k] = sinc((k - C) / 2) / 2 under a Kaiser window, C = 2 halfOrder + 1:
+    // the centre tap is 1/2 and every other tap beside it is zero, which
+    // leaves the even taps as the one branch that needs multiplies
+    const int centre = 2 * halfOrder + 1;
+    const int numBranch = 2 * halfOrder + 2;
+
+    branch.assign(size_t(numBranch), 0.f);
+
+    double sum = 0;
+    std::vector<double> taps(size_t(numBranch), 0.0);
+
+    for (int j = 0; j < numBranch; j++)
+    {
+        double x = double(2 * j - centre);
+        double r = x / centre;
+        double window = besselI0(KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(KAISER_BETA);
+
+        taps[size_t(j)] = std::sin(pi * x / 2.0) / (pi * x) * window;
+        sum += taps[size_t(j)];
+    }
+
+    // stored reversed, so the convolution runs forward through the history,
+    // and scaled so the whole filter passes DC at exactly 1
+    for (int j = 0; j < numBranch; j++)
+        branch[size_t(numBranch - 1 - j)] = float(taps[size_t(j)] * 0.5 / sum);
+}
+
+void HalfbandStage::prepare(int newHalfOrder, int maxSamples, int numChannels)
+{
+    // the taps depend on nothing else, so growing the buffers keeps them
+    if (newHalfOrder != halfOrder || branch.empty())
+        design(newHalfOrder);
+
+    auto allocate = [&](std::vector<std::vector<float>>& history)
+    {
+        history.assign(size_t(numChannels), std::vector<float>(size_t(historyLength + maxSamples), 0.f));
+    };
+
+    allocate(upHistory);
+    allocate(evenHistory);
+    allocate(oddHistory);
+    sums.assign(size_t(maxSamples), 0.f);
+}
+
+void HalfbandStage::reset()
+{
+    for (auto* histories : { &upHistory, &evenHistory, &oddHistory })
+        for (auto& history : *histories)
+            std::fill(history.begin(), history.end(), 0.f);
+}
+
+// Taps outer, samples inner: every output keeps its own sum, so the inner
+// loop vectorises without reordering a float reduction.
+static void convolve(const float* taps, int numTaps, const float* x, float* sums, int numSamples)
+{
+    std::fill(sums, sums + numSamples, 0.f);
+
+    // four taps per pass over the block, to save loads and stores of sums
+    int j = 0;
+
+    for (; j + 4 <= numTaps; j += 4)
+    {
+        const float t0 = taps[j], t1 = taps[j + 1], t2 = taps[j + 2], t3 = taps[j + 3];
+        const float* in = x + j;
+
+        for (int n = 0; n < numSamples; n++)
+            sums[n] += t0 * in[n] + t1 * in[n + 1] + t2 * in[n + 2] + t3 * in[n + 3];
+    }
+
+    for (; j < numTaps; j++)
+    {
+        const float tap = taps[j];
+        const float* in = x + j;
+
+        for (int n = 0; n < numSamples; n++)
+            sums[n] += tap * in[n];
+    }
+}
+
+void HalfbandStage::upsample(int chan, const float* in, float* out, int numSamples)
+{
+    float* history = upHistory[size_t(chan)].data();
+
+    std::memcpy(history + historyLength, in, sizeof(float) * size_t(numSamples));
+
+    convolve(branch.data(), int(branch.size()), history, sums.data(), numSamples);
+
+    for (int n = 0; n < numSamples; n++)
+    {
+        // zero stuffing halves the level, the factor 2 puts it back; the
+        // odd outputs only see the centre tap
+        out[2 * n] = 2.f * sums[size_t(n)];
+        out[2 * n + 1] = history[n + historyLength - halfOrder];
+    }
+
+    std::memmove(history, history + numSamples, sizeof(float) * size_t(historyLength));
+}
+
+void HalfbandStage::downsample(int chan, const float* in, float* out, int numSamples)
+{
+    float* even = evenHistory[size_t(chan)].data();
+    float* odd = oddHistory[size_t(chan)].data();
+
+    for (int n = 0; n < numSamples; n++)
+    {
+        even[historyLength + n] = in[2 * n];
+        odd[historyLength + n] = in[2 * n + 1];
+    }
+
+    convolve(branch.data(), int(branch.size()), even, sums.data(), numSamples);
+
+    for (int n = 0; n < numSamples; n++)
+        out[n] = sums[size_t(n)] + 0.5f * odd[historyLength + n - halfOrder - 1];
+
+    std::memmove(even, even + numSamples, sizeof(float) * size_t(historyLength));
+    std::memmove(odd, odd + numSamples, sizeof(float) * size_t(historyLength));
+}
+
+//==============================================================================
+void Oversampler::prepare(int maxBlockSize, int numChannels)
+{
+    stages[0].prepare(OVERSAMPLER_HALF_ORDER1, maxBlockSize, numChannels);
+    stages[1].prepare(OVERSAMPLER_HALF_ORDER2, 2 * maxBlockSize, numChannels);
+
+    middle.assign(size_t(numChannels), std::vector<float>(size_t(2 * maxBlockSize), 0.f));
+    top.assign(size_t(numChannels), std::vector<float>(size_t(4 * maxBlockSize), 0.f));
+    scratch.assign(size_t(numChannels), std::vector<float>(size_t(maxBlockSize), 0.f));
+    outPointers.assign(size_t(numChannels), nullptr);
+    pad.assign(size_t(numChannels), 0.f);
+}
+
+void Oversampler::reset()
+{
+    for (auto& stage : stages)
+        stage.reset();
+
+    std::fill(pad.begin(), pad.end(), 0.f);
+}
+
+float* const* Oversampler::upsample(const float* const* channels, int numChannels, int numSamples, int factor)
+{
+    for (int chan = 0; chan < numChannels; chan++)
+    {
+        float* mid = middle[size_t(chan)].data();
+
+        stages[0].upsample(chan, channels[chan], mid, numSamples);
+
+        if (factor == 4)
+        {
+            stages[1].upsample(chan, mid, top[size_t(chan)].data(), 2 * numSamples);
+            outPointers[size_t(chan)] = top[size_t(chan)].data();
+        }
+        else
+        {
+            outPointers[size_t(chan)] = mid;
+        }
+    }
+
+    return outPointers.data();
+}
+
+void Oversampler::downsampleAdding(float* const* channels, int numChannels, int numSamples, int factor)
+{
+    for (int chan = 0; chan < numChannels; chan++)
+    {
+        float* mid = middle[size_t(chan)].data();
+        float* out = scratch[size_t(chan)].data();
+
+        if (factor == 4)
+        {
+            stages[1].downsample(chan, top[size_t(chan)].data(), mid, 2 * numSamples);
+
+            // the second stage's odd latency at 2x, made even
+            float last = pad[size_t(chan)];
+            for (int n = 0; n < 2 * numSamples; n++)
+                std::swap(last, mid[n]);
+            pad[size_t(chan)] = last;
+        }
+
+        stages[0].downsample(chan, mid, out, numSamples);
+
+        for (int n = 0; n < numSamples; n++)
+            channels[chan][n] += out[n];
+    }
+}
+
+int Oversampler::getLatency(int factor)
+{
+    int latency = 0;
+
+    if (factor >= 2)
+        latency += HalfbandStage::getLatency(OVERSAMPLER_HALF_ORDER1);
+
+    if (factor >= 4)
+        latency += (HalfbandStage::getLatency(OVERSAMPLER_HALF_ORDER2) + 1) / 2;
+
+    return latency;
+}
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    Oversampler.h
+    Created: 21 Oct 2026 4:05:51pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+#define OVERSAMPLER_MAX_STAGES  2       // up to 4x
+#define OVERSAMPLER_HALF_ORDER1 29      // first stage: 119 taps, flat to 0.45 fs
+#define OVERSAMPLER_HALF_ORDER2 6       // second stage: 27 taps, only has to clear the first's images
+
+/*
+    2x / 4x up- and downsampling for the few bands the bank runs above the
+    base rate, the same job juce::dsp::Oversampling does but without JUCE,
+    so the bank stays free of it.
+
+    Each stage is a Kaiser-windowed (beta 10, about -100 dB) half-band FIR
+    split into its two polyphase branches: one branch is a pure delay, so a
+    stage costs about half its taps per base-rate sample in each direction.
+    The filters are linear phase, which is what lets the oversampled bands
+    sum with the base-rate ones once those are delayed by getLatency:
+    anything with a frequency-dependent delay would smear the crossover
+    between the two groups. Up and down together delay by a whole number of
+    base-rate samples (the 4x chain is padded by one sample at 2x for that).
+*/
+
+class HalfbandStage
+{
+public:
+    // taps 4 halfOrder + 3, with state for numSamples in at the lower rate
+    void prepare(int halfOrder, int maxSamples, int numChannels);
+    void reset();
+
+    // numSamples in, 2 numSamples out
+    void upsample(int chan, const float* in, float* out, int numSamples);
+
+    // 2 numSamples in, numSamples out
+    void downsample(int chan, const float* in, float* out, int numSamples);
+
+    // up then down, in samples at the lower rate
+    static int getLatency(int halfOrder) { return 2 * halfOrder + 1; }
+
+private:
+    void design(int halfOrder);
+
+    int halfOrder {0};
+    int historyLength {0};
+    std::vector<float> branch;      // the non-trivial polyphase branch, 2 halfOrder + 2 taps
+
+    // per channel: the last historyLength samples followed by the block
+    std::vector<std::vector<float>> upHistory, evenHistory, oddHistory;
+    std::vector<float> sums;
+};
+
+class Oversampler
+{
+public:
+    void prepare(int maxBlockSize, int numChannels);
+    void reset();
+
+    // factor 2 or 4; returns the upsampled channels, factor * numSamples long,
+    // in buffers the oversampler owns
+    float* const* upsample(const float* const* channels, int numChannels, int numSamples, int factor);
+
+    // brings the buffers upsample returned back down and adds them onto channels
+    void downsampleAdding(float* const* channels, int numChannels, int numSamples, int factor);
+
+    // base-rate samples from upsample to downsampleAdding; 0 for factor 1
+    static int getLatency(int factor);
+
+private:
+    HalfbandStage stages[OVERSAMPLER_MAX_STAGES];
+
+    std::vector<std::vector<float>> middle, top, scratch;
+    std::vector<float*> outPointers;
+    std::vector<float> pad;         // one 2x-rate sample per channel, see above
+};
@@ -0,0 +1,321 @@
+/*
+  ==============================================================================
+
+    PartialMap.cpp
+    Created: 23 Oct 2026 9:12:48am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "PartialMap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #include <windows.h>
+#else
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+static const char partialMapMagic[4] = { 'T', 'H', 'P', 'M' };
+
+struct PartialMapHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t numPartials;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PartialMapHeader) == 16, "the arrays start 16 bytes in");
+
+#if defined(_WIN32)
+static std::wstring toWide(const std::string& path)
+{
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring wide(size_t(std::max(length, 1)), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], length);
+    wide.resize(wide.size() - 1);
+    return wide;
+}
+#endif
+
+//==============================================================================
+// A read-only view of a whole file, and what it looked like when mapped
+struct PartialMap::Mapping
+{
+    const unsigned char* data {nullptr};
+    uint64_t size {0};
+    int64_t modified {0};
+    uint64_t inode {0};         // POSIX: write() renames a new file in, so this changes too
+
+   #if defined(_WIN32)
+    HANDLE file {INVALID_HANDLE_VALUE};
+    HANDLE view {nullptr};
+   #endif
+
+    ~Mapping()
+    {
+       #if defined(_WIN32)
+        if (data != nullptr)
+            UnmapViewOfFile(data);
+        if (view != nullptr)
+            CloseHandle(view);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+       #else
+        if (data != nullptr)
+            munmap(const_cast<unsigned char*>(data), size_t(size));
+       #endif
+    }
+
+    bool open(const std::string& path)
+    {
+       #if defined(_WIN32)
+        file = CreateFileW(toWide(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER length;
+        FILETIME writeTime;
+        if (! GetFileSizeEx(file, &length) || ! GetFileTime(file, nullptr, nullptr, &writeTime))
+            return false;
+
+        size = uint64_t(length.QuadPart);
+        modified = (int64_t(writeTime.dwHighDateTime) << 32) | writeTime.dwLowDateTime;
+
+        if (size == 0)
+            return true;
+
+        view = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (view == nullptr)
+            return false;
+
+        data = static_cast<const unsigned char*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+        return data != nullptr;
+       #else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0;
+
+        if (ok)
+        {
+            size = uint64_t(info.st_size);
+            modified = int64_t(info.st_mtime);
+            inode = uint64_t(info.st_ino);
+
+            if (size > 0)
+            {
+                void* mapped = mmap(nullptr, size_t(size), PROT_READ, MAP_PRIVATE, fd, 0);
+                ok = mapped != MAP_FAILED;
+                data = ok ? static_cast<const unsigned char*>(mapped) : nullptr;
+            }
+        }
+
+        // the mapping keeps the file, not the descriptor
+        ::close(fd);
+        return ok;
+       #endif
+    }
+};
+
+//==============================================================================
+// Loaded maps by path, so banks loading the same file share one
+namespace
+{
+    struct MapCache
+    {
+        std::mutex lock;
+        std::unordered_map<std::string, std::weak_ptr<const PartialMap>> maps;
+    };
+
+    MapCache& getMapCache()
+    {
+        static MapCache cache;
+        return cache;
+    }
+}
+
+PartialMap::PartialMap() {}
+
+PartialMap::~PartialMap() {}
+
+std::shared_ptr<const PartialMap> PartialMap::load(const std::string& path, std::string* error)
+{
+    auto fail = [error](const std::string& reason)
+    {
+        if (error != nullptr)
+            *error = reason;
+
+        return std::shared_ptr<const PartialMap>();
+    };
+
+    auto& cache = getMapCache();
+    std::lock_guard<std::mutex> guard(cache.lock);
+
+    std::unique_ptr<Mapping> mapping(new Mapping());
+
+    if (! mapping->open(path))
+        return fail("cannot map " + path);
+
+    // the same file, unchanged since it was loaded
+    if (auto existing = cache.maps[path].lock())
+        if (existing->mapping->size == mapping->size && existing->mapping->modified == mapping->modified
+            && existing->mapping->inode == mapping->inode)
+            return existing;
+
+    PartialMapHeader header;
+
+    if (mapping->size < sizeof(header))
+        return fail("not a partial map");
+
+    std::memcpy(&header, mapping->data, sizeof(header));
+
+    if (std::memcmp(header.magic, partialMapMagic, sizeof(partialMapMagic)) != 0)
+        return fail("not a partial map");
+
+    if (header.version != PARTIAL_MAP_VERSION)
+        return fail("unsupported partial map version " + std::to_string(header.version));
+
+    const uint64_t n = header.numPartials;
+
+    if (n == 0 || n > uint64_t(INT32_MAX) || mapping->size != sizeof(header) + 3 * n * sizeof(float))
+        return fail("corrupt partial map header");
+
+    std::shared_ptr<PartialMap> map(new PartialMap());
+
+    map->numPartials = int(n);
+    map->ratios = reinterpret_cast<const float*>(mapping->data + sizeof(header));
+    map->gains = map->ratios + n;
+    map->qScales = map->gains + n;
+    map->logRatios.resize(size_t(n));
+    map->logQScales.resize(size_t(n));
+
+    // the one pass over the file: checks every partial and takes the logs
+    // the coefficient update works in
+    for (size_t i = 0; i < size_t(n); i++)
+    {
+        const float ratio = map->ratios[i], gain = map->gains[i], qScale = map->qScales[i];
+
+        if (! (std::isfinite(ratio) && ratio > 0.f) || (i > 0 && ratio < map->ratios[i - 1]))
+            return fail("partial " + std::to_string(i) + ": ratios must be positive and ascending");
+
+        if (! (std::isfinite(gain) && gain >= 0.f) || ! (std::isfinite(qScale) && qScale > 0.f))
+            return fail("partial " + std::to_string(i) + ": bad gain or Q");
+
+        map->logRatios[i] = std::log(ratio);
+        map->logQScales[i] = std::log(qScale);
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+
+    for (uint64_t i = 0; i < mapping->size; i++)
+        hash = (hash ^ uint64_t(mapping->data[i])) * 1099511628211ull;
+
+    static std::atomic<uint32_t> nextId {1};
+
+    map->id = nextId++;
+    map->contentHash = hash;
+    map->path = path;
+    map->mapping = std::move(mapping);
+
+    cache.maps[path] = map;
+
+    return map;
+}
+
+bool PartialMap::write(const std::string& path, std::vector<Partial> partials, std::string* error)
+{
+    auto fail = [error](const std::string& reason)
+    {
+        if (error != nullptr)
+            *error = reason;
+
+        return false;
+    };
+
+    if (partials.empty())
+        return fail("no partials");
+
+    std::stable_sort(partials.begin(), partials.end(), [](const Partial& a, const Partial& b)
+    {
+        return a.ratio < b.ratio;
+    });
+
+    const size_t n = partials.size();
+    std::vector<float> arrays(3 * n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const Partial& partial = partials[i];
+
+        if (! (std::isfinite(partial.ratio) && partial.ratio > 0.f)
+            || ! (std::isfinite(partial.gain) && partial.gain >= 0.f)
+            || ! (std::isfinite(partial.qScale) && partial.qScale > 0.f))
+            return fail("partial " + std::to_string(i) + " out of range");
+
+        arrays[i] = partial.ratio;
+        arrays[n + i] = partial.gain;
+        arrays[2 * n + i] = partial.qScale;
+    }
+
+    PartialMapHeader header;
+    std::memcpy(header.magic, partialMapMagic, sizeof(partialMapMagic));
+    header.version = PARTIAL_MAP_VERSION;
+    header.numPartials = uint32_t(n);
+    header.reserved = 0;
+
+    const std::string temp = path + ".tmp";
+
+   #if defined(_WIN32)
+    FILE* file = _wfopen(toWide(temp).c_str(), L"wb");
+   #else
+    FILE* file = std::fopen(temp.c_str(), "wb");
+   #endif
+
+    if (file == nullptr)
+        return fail("cannot write " + temp);
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+                && std::fwrite(arrays.data(), sizeof(float), arrays.size(), file) == arrays.size();
+
+    written = std::fclose(file) == 0 && written;
+
+   #if defined(_WIN32)
+    bool renamed = written && MoveFileExW(toWide(temp).c_str(), toWide(path).c_str(), MOVEFILE_REPLACE_EXISTING);
+   #else
+    bool renamed = written && std::rename(temp.c_str(), path.c_str()) == 0;
+   #endif
+
+    if (! renamed)
+    {
+       #if defined(_WIN32)
+        _wremove(toWide(temp).c_str());
+       #else
+        std::remove(temp.c_str());
+       #endif
+        return fail("cannot write " + path);
+    }
+
+    return true;
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    PartialMap.h
+    Created: 23 Oct 2026 9:12:48am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define PARTIAL_MAP_VERSION 1
+
+/*
+    A loadable set of partials for the bank in place of the harmonic series,
+    for bell, bar and membrane spectra: per partial a frequency ratio to the
+    Center Frequency, a gain, and a multiplier on the band's Q.
+
+    File layout (little-endian, 16-byte header so the arrays stay aligned):
+        "THPM", uint32 version, uint32 numPartials, uint32 0
+        float ratio[numPartials]    ascending, > 0
+        float gain[numPartials]     >= 0
+        float qScale[numPartials]   > 0
+
+    The file is memory-mapped rather than read, so a map of thousands of
+    partials costs one pass over it at load, and every bank that loads the
+    same file gets the same read-only PartialMap. Because the ratios are
+    sorted the coefficient update can stop at the first partial past
+    nyquist, as it does for the harmonics.
+
+    Maps are loaded and released off the audio thread: the last release
+    unmaps the file.
+*/
+
+struct Partial
+{
+    float ratio {1.f};
+    float gain {1.f};
+    float qScale {1.f};
+};
+
+class PartialMap
+{
+public:
+    ~PartialMap();
+
+    // The map in the file at path (UTF-8), shared with every other bank that
+    // has it loaded unless the file has changed since; nullptr, with the
+    // reason in error, if it cannot be mapped or is not a valid map.
+    static std::shared_ptr<const PartialMap> load(const std::string& path, std::string* error = nullptr);
+
+    // Writes partials to path in the layout above, sorted by ratio. The file
+    // is written beside path and renamed over it, so banks that have the old
+    // one mapped keep reading it intact.
+    static bool write(const std::string& path, std::vector<Partial> partials, std::string* error = nullptr);
+
+    int getNumPartials() const { return numPartials; }
+
+    // numPartials each; the first three point into the mapped file
+    const float* getRatios() const { return ratios; }
+    const float* getGains() const { return gains; }
+    const float* getQScales() const { return qScales; }
+    const float* getLogRatios() const { return logRatios.data(); }     // for Detune: ratio ^ detune
+    const float* getLogQScales() const { return logQScales.data(); }
+
+    // never reused within a process, so coefficient sets can be cached by it
+    uint32_t getId() const { return id; }
+
+    const std::string& getPath() const { return path; }
+
+    // FNV-1a over the file's bytes, to tell whether the file at a path is
+    // still the map that was loaded from it
+    uint64_t getContentHash() const { return contentHash; }
+
+private:
+    struct Mapping;
+
+    PartialMap();
+
+    std::unique_ptr<Mapping> mapping;
+    int numPartials {0};
+    const float* ratios {nullptr};
+    const float* gains {nullptr};
+    const float* qScales {nullptr};
+    std::vector<float> logRatios;
+    std::vector<float> logQScales;
+    uint32_t id {0};
+    uint64_t contentHash {0};
+    std::string path;
+};
@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    PipelineRunner.cpp
+    Created: 19 Oct 2026 4:12:48pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "PipelineRunner.h"
+
+PipelineRunner::PipelineRunner(HarmonicBank& bankToRun)
+    : juce::Thread("Thesis pipeline"), bank(bankToRun)
+{
+}
+
+PipelineRunner::~PipelineRunner()
+{
+    release();
+}
+
+//==============================================================================
+void PipelineRunner::prepare(int maxBlockSize, int newNumChannels)
+{
+    // an idle worker with rings for this block size carries on; the latency
+    // is the block size, so any other size starts over
+    if (isThreadRunning() && ! active && maxBlockSize == latency
+        && juce::jmin(newNumChannels, MAX_CHANNELS) == numChannels)
+        return;
+
+    release();
+
+    latency = maxBlockSize;
+    numChannels = juce::jmin(newNumChannels, MAX_CHANNELS);
+
+    inFifo.setTotalSize(3 * maxBlockSize + 1);
+    outFifo.setTotalSize(4 * maxBlockSize + 1);
+
+    inRing.setSize(MAX_CHANNELS, inFifo.getTotalSize());
+    outRing.setSize(MAX_CHANNELS, outFifo.getTotalSize());
+    workBuffer.setSize(MAX_CHANNELS, maxBlockSize);
+
+    startThread(10);
+}
+
+void PipelineRunner::release()
+{
+    running = false;
+    active = false;
+    wake.signal();
+    stopThread(1000);
+}
+
+//==============================================================================
+void PipelineRunner::start()
+{
+    if (! isThreadRunning())
+        return;
+
+    // a stop() that has not gone through yet is simply cancelled
+    if (active)
+    {
+        running = true;
+        return;
+    }
+
+    // the worker is idle, so the rings belong to this thread until running is set
+    inFifo.reset();
+    outFifo.reset();
+    settingsFifo.reset();
+    missedSamples = 0;
+
+    // one block of silence ahead of the first processed block
+    int start1, size1, start2, size2;
+    outFifo.prepareToWrite(latency, start1, size1, start2, size2);
+    outRing.clear(start1, size1);
+    if (size2 > 0)
+        outRing.clear(start2, size2);
+    outFifo.finishedWrite(size1 + size2);
+
+    active = true;
+    running = true;
+}
+
+bool PipelineRunner::stop()
+{
+    if (! active)
+        return true;
+
+    running = false;
+
+    // the worker sets busy before it checks running, so once running is
+    // clear and busy is not, it cannot touch the bank again
+    if (busy)
+        return false;
+
+    active = false;
+    return true;
+}
+
+void PipelineRunner::process(juce::AudioBuffer<float>& buffer, int numChans, const BankSettings& settings)
+{
+    int numSamples = buffer.getNumSamples();
+    int start1, size1, start2, size2;
+
+    numChans = juce::jmin(numChans, numChannels);
+
+    if (settingsFifo.getFreeSpace() > 0)
+    {
+        settingsFifo.prepareToWrite(1, start1, size1, start2, size2);
+        settingsRing[start1] = settings;
+        settingsFifo.finishedWrite(1);
+    }
+
+    // hand the input to the worker...
+    inFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    for (int chan = 0; chan < numChans; chan++)
+    {
+        inRing.copyFrom(chan, start1, buffer, chan, 0, size1);
+        if (size2 > 0)
+            inRing.copyFrom(chan, start2, buffer, chan, size1, size2);
+    }
+    inFifo.finishedWrite(size1 + size2);
+
+    // input the ring had no room for never reaches the output either
+    int dropped = numSamples - (size1 + size2);
+    if (dropped > 0)
+        missedSamples += dropped;
+
+    {
+        // a brief uncontended lock, and the only way to wake the worker promptly
+        THESIS_RT_ALLOW;
+        wake.signal();
+    }
+
+    // ...and take back what it finished earlier
+    outFifo.prepareToRead(numSamples, start1, size1, start2, size2);
+    for (int chan = 0; chan < numChans; chan++)
+    {
+        buffer.copyFrom(chan, 0, outRing, chan, start1, size1);
+        if (size2 > 0)
+            buffer.copyFrom(chan, size1, outRing, chan, start2, size2);
+    }
+    outFifo.finishedRead(size1 + size2);
+
+    int missing = numSamples - (size1 + size2);
+    if (missing > 0)
+    {
+        for (int chan = 0; chan < numChans; chan++)
+            buffer.clear(chan, size1 + size2, missing);
+
+        missedSamples += missing;
+    }
+}
+
+//==============================================================================
+void PipelineRunner::run()
+{
+    while (! threadShouldExit())
+    {
+        wake.wait(10);
+
+        busy = true;
+
+        if (running)
+            processPending();
+
+        busy = false;
+    }
+}
+
+void PipelineRunner::processPending()
+{
+    int start1, size1, start2, size2;
+
+    for (;;)
+    {
+        int numSamples = juce::jmin(inFifo.getNumReady(), outFifo.getFreeSpace(), workBuffer.getNumSamples());
+
+        if (numSamples <= 0)
+            return;
+
+        // only the newest settings matter
+        int numSettings = settingsFifo.getNumReady();
+        if (numSettings > 0)
+        {
+            settingsFifo.prepareToRead(numSettings, start1, size1, start2, size2);
+            bank.setSettings(settingsRing[size2 > 0 ? start2 + size2 - 1 : start1 + size1 - 1]);
+            settingsFifo.finishedRead(size1 + size2);
+        }
+
+        inFifo.prepareToRead(numSamples, start1, size1, start2, size2);
+        for (int chan = 0; chan < numChannels; chan++)
+        {
+            workBuffer.copyFrom(chan, 0, inRing, chan, start1, size1);
+            if (size2 > 0)
+                workBuffer.copyFrom(chan, size1, inRing, chan, start2, size2);
+        }
+        inFifo.finishedRead(size1 + size2);
+
+        bank.process(workBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+        outFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+        for (int chan = 0; chan < numChannels; chan++)
+        {
+            outRing.copyFrom(chan, start1, workBuffer, chan, 0, size1);
+            if (size2 > 0)
+                outRing.copyFrom(chan, start2, workBuffer, chan, size1, size2);
+        }
+        outFifo.finishedWrite(size1 + size2);
+    }
+}
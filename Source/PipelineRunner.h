@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    PipelineRunner.h
+    Created: 19 Oct 2026 4:12:48pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "HarmonicBank.h"
+#include "RealtimeCheck.h"
+
+/*
+    Optional pipelined processing: the host callback only queues its input
+    for a real-time worker thread and takes back audio the worker finished
+    earlier, so the bank gets a whole block period to run in exchange for
+    maxBlockSize samples of latency.
+
+    Audio moves through lock-free rings three blocks long (juce::AbstractFifo)
+    instead of fixed block slots, so hosts that vary their block size stay
+    sample-aligned. Settings travel through their own small FIFO. The
+    output ring starts with one block of silence, which is the latency the
+    processor reports. If the worker ever falls behind, the missing samples
+    come out silent and are counted.
+
+    start() and stop() are called from the audio thread; stop() only
+    succeeds once the worker has let go of the bank, so the caller keeps
+    using the pipeline until it returns true.
+*/
+
+class PipelineRunner  : private juce::Thread
+{
+public:
+    PipelineRunner(HarmonicBank& bankToRun);
+    ~PipelineRunner() override;
+
+    // message thread: allocates the rings and starts the (idle) worker,
+    // unless it is already idling with rings for this block size
+    void prepare(int maxBlockSize, int numChannels);
+    void release();
+
+    // audio thread
+    void start();
+    bool stop();
+    void process(juce::AudioBuffer<float>& buffer, int numChannels, const BankSettings& settings);
+
+    bool isActive() const { return active; }
+    int getLatencySamples() const { return latency; }
+    int getNumMissedSamples() const { return missedSamples.load(); }
+
+private:
+    void run() override;
+    void processPending();
+
+    HarmonicBank& bank;
+
+    juce::AbstractFifo inFifo {1}, outFifo {1}, settingsFifo {8};
+    juce::AudioBuffer<float> inRing, outRing, workBuffer;
+    BankSettings settingsRing[8];
+
+    juce::WaitableEvent wake;
+    std::atomic<bool> running {false};
+    std::atomic<bool> busy {false};
+    std::atomic<int> missedSamples {0};
+
+    bool active {false};
+    int latency {0};
+    int numChannels {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PipelineRunner)
+};
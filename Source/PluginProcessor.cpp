@@ -1,520 +1,639 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-ThesisAudioProcessor::ThesisAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
-#endif
-{
-}
-
-ThesisAudioProcessor::~ThesisAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String ThesisAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool ThesisAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool ThesisAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool ThesisAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double ThesisAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int ThesisAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int ThesisAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void ThesisAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String ThesisAudioProcessor::getProgramName (int index)
-{
-    return {};
-}
-
-void ThesisAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void ThesisAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    modVector.clear();
-    for (int samp = 0; samp < samplesPerBlock; samp++)
-        modVector.push_back(0.f);
-    
-    mod.initMod(sampleRate);
-    mod.setMod(1.f);
-    
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
-    
-    for (int i = 0; i < NUM_HARM; i++)
-    {
-        leftChain[i].prepare(spec);
-        leftChain[i].get<BPChainPositions::BPFilter>().setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-        rightChain[i].prepare(spec);
-        rightChain[i].get<BPChainPositions::BPFilter>().setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-    }
-    
-    updateAll();
-}
-
-void ThesisAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-    for (int i = 0; i < NUM_HARM; i++)
-    {
-        leftChain[i].reset();
-        rightChain[i].reset();
-    }
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool ThesisAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-#endif
-
-void ThesisAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-    // initialize variables
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto chainSettings = getChainSettings(apvts);
-    int bufferSize = buffer.getNumSamples();
-    int numHarm = int(50.f * pow(2.f, float(chainSettings.quality)));
-    bool modState;
-    float freq, modVal[bufferSize], nyquist, modDepth, detune;
-    
-    nyquist = float(getSampleRate()) / 2.f;
-    detune = chainSettings.detune;
-    modDepth = chainSettings.modDepth / 100.f;
-    modState = chainSettings.modDetune || chainSettings.modFreq;
-    mod.updateMod(chainSettings.modRate);
-    
-    // Fill modulator array with values
-    for (int i = 0; i < bufferSize; i++)
-        modVector[i] = mod.modBlock(bufferSize)[i] * modDepth;
-    
-    // update dsp based on parameters
-    updateAll();
-    
-    // copy contents of input buffer and create a temporary buffer to fill
-    juce::AudioBuffer<float> effectBuffer;
-    effectBuffer.makeCopyOf(buffer);
-    
-    juce::AudioBuffer<float> tempBuffer;
-    
-    //for loop that iterates over how many BP filters will be made
-    for (int harm = 0; harm < numHarm; harm++)
-    {
-        tempBuffer.makeCopyOf(buffer);
-        freq = getCurFreq(chainSettings, harm);
-        
-        if (freq < nyquist)
-        {
-            if (modState)
-                processWithMod(tempBuffer, chainSettings, modVal, harm);
-            else
-                processNoMod(tempBuffer, harm);
-            
-            // fill effectBuffer with each harmonic tempBuffer
-            if (harm == 0)
-                for (int chan = 0; chan < totalNumInputChannels; chan++)
-                    effectBuffer.copyFrom(chan, 0, tempBuffer, chan, 0, bufferSize);
-            else
-                for (int chan = 0; chan < totalNumInputChannels; chan++)
-                    effectBuffer.addFrom(chan, 0, tempBuffer, chan, 0, bufferSize);
-        }
-        else
-            break;
-    }
-    
-    buffer.makeCopyOf(effectBuffer);
-}
-
-void ThesisAudioProcessor::processNoMod(juce::AudioBuffer<float> &buffer, int harm)
-{
-    juce::dsp::AudioBlock<float> tempBlock(buffer);
-                
-    auto leftBlock = tempBlock.getSingleChannelBlock(LEFT_CHANNEL);
-    auto rightBlock = tempBlock.getSingleChannelBlock(RIGHT_CHANNEL);
-                
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-                
-    leftChain[harm].process(leftContext);
-    rightChain[harm].process(rightContext);
-}
-
-void ThesisAudioProcessor::processWithMod(juce::AudioBuffer<float> &buffer, const ChainSettings &chainSettings, float* modVal, int harm)
-{
-    int bufferSize = buffer.getNumSamples();
-    
-    float leftSamp, rightSamp;
-    
-    bool filterCheck = true;
-    
-    //iterate through each sample in buffer to fill harmonic tempBuffer
-    for (int n = 0; n < bufferSize; n++)
-    {
-        //update BP filter's frequency based on modulator
-        filterCheck = updateSVFilter(chainSettings, harm);
-
-        leftSamp = buffer.getSample(LEFT_CHANNEL, n);
-        rightSamp = buffer.getSample(RIGHT_CHANNEL, n);
-        
-        // 1.) apply band-pass filter to sample
-        leftSamp = leftChain[harm].get<BPChainPositions::BPFilter>().processSample(LEFT_CHANNEL, leftSamp);
-        rightSamp = rightChain[harm].get<BPChainPositions::BPFilter>().processSample(RIGHT_CHANNEL, rightSamp);
-        
-        // 2.) apply curve gain
-        leftSamp = leftChain[harm].get<BPChainPositions::CurveGain>().processSample(leftSamp);
-        rightSamp = rightChain[harm].get<BPChainPositions::CurveGain>().processSample(rightSamp);
-        
-        // 3.) apply odd/even harmonic gain
-        leftSamp = leftChain[harm].get<BPChainPositions::OddEvenGain>().processSample(leftSamp);
-        rightSamp = rightChain[harm].get<BPChainPositions::OddEvenGain>().processSample(rightSamp);
-        
-        // 4.) rewrite sample to tempBuffer
-        buffer.setSample(LEFT_CHANNEL, n, leftSamp);
-        buffer.setSample(RIGHT_CHANNEL, n, rightSamp);
-        
-        // 5.) silence sample if the frequency is outside of bounds
-        if (!filterCheck)
-            buffer.applyGainRamp(0, n, 1.f, 0.f);
-    }
-}
-
-void ThesisAudioProcessor::updateAll()
-{
-    ChainSettings chainSettings = getChainSettings(apvts);
-    
-    float freq;
-    
-    float nyquist = float(getSampleRate()) / 2.f;
-    
-    for (int i = 0; i < NUM_HARM; i++)
-    {
-        freq = getCurFreq(chainSettings, i);
-        
-        if (freq < nyquist)
-        {
-            updateSVFilter(chainSettings, i);
-            updateCurveGain(chainSettings, i);
-            updateOddEvenGain(chainSettings, i);
-        }
-        else
-            break;
-    }
-}
-
-bool ThesisAudioProcessor::updateSVFilter(const ChainSettings &chainSettings, int i)
-{
-    float freq, q, nyquist;
-    
-    freq = getCurFreq(chainSettings, i);
-    q = chainSettings.q * (float(i) / 2.f + 1);
-    
-    freq = wrap(freq, getSampleRate());
-    
-    nyquist = getSampleRate() / 2.f;
-    
-    if (freq < 20.f || freq >= nyquist)
-        return false;
-    
-    //LEFT CHANNEL
-    leftChain[i].get<BPChainPositions::BPFilter>().setCutoffFrequency(freq);
-    leftChain[i].get<BPChainPositions::BPFilter>().setResonance(q);
-    
-    //RIGHT CHANNEL
-    rightChain[i].get<BPChainPositions::BPFilter>().setCutoffFrequency(freq);
-    rightChain[i].get<BPChainPositions::BPFilter>().setResonance(q);
-    
-    return true;
-}
-
-void ThesisAudioProcessor::updateCurveGain(const ChainSettings &chainSettings, int i)
-{
-    float gain, normGain, q;
-    
-    q = chainSettings.q * (float(i) / 2.f + 1);
-    
-    normGain = pow((1.f/q), 0.8);
-    
-    gain = pow((-1.f / float(NUM_HARM)) * float(i) + 1.f, (1.f / chainSettings.curve));
-    
-    gain *= normGain;
-    
-    leftChain[i].get<BPChainPositions::CurveGain>().setGainLinear(gain);
-    rightChain[i].get<BPChainPositions::CurveGain>().setGainLinear(gain);
-}
-
-void ThesisAudioProcessor::updateOddEvenGain(const ChainSettings &chainSettings, int i)
-{
-    float timbre, oddGain, evenGain;
-    
-    timbre = chainSettings.timbre;
-    oddGain = timbre * -1.f + 1.f;
-    evenGain = timbre;
-    
-    if (i == 0)
-    {
-        leftChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(1.f);
-        rightChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(1.f);
-    }
-    else if (i % 2 == 1)
-    {
-        leftChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(oddGain);
-        rightChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(oddGain);
-    }
-    else if (i % 2 == 0)
-    {
-        leftChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(evenGain);
-        rightChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(evenGain);
-    }
-}
-
-float ThesisAudioProcessor::wrap(float x, int sampleRate)
-{
-    float y;
-    
-    if (x > sampleRate / 2)
-        y = x - int(ceil( x )) % sampleRate;
-    
-    else if (x < 20)
-        y = 20 - x + 20;
-    
-    else
-        y = x;
-        
-    return y;
-}
-
-float ThesisAudioProcessor::getCurFreq(const ChainSettings& chainSettings, int harm)
-{
-    float fc, detune, outFreq, freqModVal;
-    
-    fc = chainSettings.freq;
-    
-    freqModVal = chainSettings.modFreq ? modVector[harm] : 0.f;
-    
-    if (harm > 0)
-    {
-        detune = chainSettings.detune;
-        
-        if (chainSettings.modDetune)
-            detune += (modVector[harm] / 200.f);
-    }
-    else
-        detune = 1;
-    
-    detune = detune == 0 ? detune = 0.1 : detune;
-    
-    outFreq = (freqModVal + 1.f) * fc * pow(float(harm + 1), detune);
-    
-    return outFreq;
-}
-
-//==============================================================================
-bool ThesisAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* ThesisAudioProcessor::createEditor()
-{
-//    return new ThesisAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor (*this);
-}
-
-//==============================================================================
-void ThesisAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
-}
-
-void ThesisAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
-    if ( tree.isValid() )
-    {
-        apvts.replaceState(tree);
-        updateAll();
-    }
-}
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
-{
-    ChainSettings settings;
-    
-    //==============================================================================
-    settings.timbre = apvts.getRawParameterValue("Timbre")->load();
-    settings.freq = apvts.getRawParameterValue("Center Frequency")->load();
-    settings.q = apvts.getRawParameterValue("Q")->load();
-    
-    //==============================================================================
-    settings.stereoLink = apvts.getRawParameterValue("Stereo Link")->load();
-    settings.quality = apvts.getRawParameterValue("Quality")->load();
-    settings.curve = apvts.getRawParameterValue("Curve")->load();
-    settings.detune = apvts.getRawParameterValue("Detune")->load();
-    
-    //==============================================================================
-    settings.modFreq = apvts.getRawParameterValue("Mod Freq")->load();
-    settings.modDetune = apvts.getRawParameterValue("Mod Detune")->load();
-    settings.modDepth = apvts.getRawParameterValue("Mod Depth")->load();
-    settings.modRate = apvts.getRawParameterValue("Mod Rate")->load();
-    
-    return settings;
-}
-
-juce::AudioProcessorValueTreeState::ParameterLayout
-    ThesisAudioProcessor::createParameterLayout()
-{
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    
-    //==============================================================================
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Timbre",
-                                                           "Timbre",
-                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.05f, 1.f),
-                                                           0.5f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Center Frequency",
-                                                           "Center Frequency",
-                                                           juce::NormalisableRange<float>(20.f, 10000.f, 1.f, 0.25f),
-                                                           100.f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Q",
-                                                           "Q",
-                                                           juce::NormalisableRange<float>(1.f, 100.f, 0.1f, 1.f),
-                                                           20.f));
-        
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Detune",
-                                                           "Detune",
-                                                           juce::NormalisableRange<float>(0.5f, 2.f, 0.01f, 1.f),
-                                                           1.f));
-        
-    //==============================================================================
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Stereo Link",
-                                                           "Stereo Link",
-                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.05f, 1.f),
-                                                           1.f));
-        
-    layout.add(std::make_unique<juce::AudioParameterInt>("Quality",
-                                                         "Quality",
-                                                         0, 2, 1));
-        
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Curve",
-                                                           "Curve",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.1f, 0.25f),
-                                                           1.f));
-    
-        
-    //==============================================================================
-    layout.add(std::make_unique<juce::AudioParameterBool>("Mod Freq", "Mod Freq", false));
-        
-    layout.add(std::make_unique<juce::AudioParameterBool>("Mod Detune", "Mod Detune", false));
-        
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Mod Depth",
-                                                           "Mod Depth",
-                                                           juce::NormalisableRange<float>(0.f, 100.f, 0.1f, 1.f),
-                                                           1.f));
-        
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Mod Rate",
-                                                           "Mod Rate",
-                                                           juce::NormalisableRange<float>(0.1f, 20.f, 0.1f, 1.f),
-                                                           1.f));
-    
-    return layout;
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new ThesisAudioProcessor();
-}
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+ThesisAudioProcessor::ThesisAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                       .withOutput ("Follow", juce::AudioChannelSet::mono(), false)
+                     #endif
+                       )
+#endif
+{
+    // Quality and Extended Quality together reach MAX_QUALITY; prepare makes
+    // room for all of it up front, so turning Quality up during playback
+    // only switches more bands on, as it did with the fixed 200
+    bank.setQualityCeiling(MAX_QUALITY);
+}
+
+ThesisAudioProcessor::~ThesisAudioProcessor()
+{
+}
+
+//==============================================================================
+const juce::String ThesisAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool ThesisAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool ThesisAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool ThesisAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double ThesisAudioProcessor::getTailLengthSeconds() const
+{
+    return 0.0;
+}
+
+int ThesisAudioProcessor::getNumPrograms()
+{
+    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int ThesisAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void ThesisAudioProcessor::setCurrentProgram (int index)
+{
+}
+
+const juce::String ThesisAudioProcessor::getProgramName (int index)
+{
+    return {};
+}
+
+void ThesisAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+}
+
+//==============================================================================
+void ThesisAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    auto start = juce::Time::getHighResolutionTicks();
+    auto chainSettings = getChainSettings(apvts);
+    
+    bank.setSettings(chainSettings);
+    
+    // a bounce announced before prepare gets the offline profile's worker
+    // threads here, so processBlock only ever has to switch over
+    bank.setOffline(isNonRealtime());
+    bank.prepare(sampleRate, samplesPerBlock, getTotalNumInputChannels());
+    
+    pipeline.prepare(samplesPerBlock, getTotalNumInputChannels());
+    updatePipelineMode(pipelined->load() && ! isNonRealtime());
+    updateLatency(chainSettings.oversampling, pipeline.isActive());
+    
+    // room for the most latency there can be: the pipeline's block and the
+    // oversampling filters
+    bypassDelay.setSize(getTotalNumInputChannels(),
+                        samplesPerBlock + HarmonicBank::getOversamplingLatency(1) + 1);
+    bypassDelay.clear();
+    bypassDelayPos = 0;
+    
+    prepareMicros = float(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6);
+}
+
+void ThesisAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+    pipeline.release();
+    setLatencySamples(0);
+    bank.reset();
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool ThesisAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // This is the place where you check if the layout is supported.
+    // In this template code we only support mono or stereo.
+    // Some plugin hosts, such as certain GarageBand versions, will only
+    // load plugins that support stereo bus layouts.
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+   #endif
+
+    // the follow output is one channel, or off
+    if (layouts.outputBuses.size() > 1
+     && ! layouts.outputBuses[1].isDisabled()
+     && layouts.outputBuses[1] != juce::AudioChannelSet::mono())
+        return false;
+
+    return true;
+  #endif
+}
+#endif
+
+void ThesisAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    THESIS_RT_REGION;
+    
+    juce::ScopedNoDenormals noDenormals;
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    
+    auto chainSettings = chainParameters.load();
+    
+    // bounces always render every harmonic
+    if (isNonRealtime())
+        chainSettings.governor = false;
+    
+    // Bounces take the bank's offline profile, at the same latency. Only
+    // while the bank is ours: the pipeline never runs offline, and the
+    // switch back happens here before it can start again. prepareToPlay
+    // starts the profile's threads when the host announces the render
+    // first, as hosts do; otherwise the render keeps the realtime profile
+    // rather than start them here.
+    if (! pipeline.isActive() && bank.isOffline() != isNonRealtime()
+        && (bank.isOffline() || bank.isOfflineReady()))
+        bank.setOffline(isNonRealtime());
+    
+    // offline renders have no deadline to buy headroom against
+    updatePipelineMode(pipelined->load() && ! isNonRealtime());
+    updateLatency(chainSettings.oversampling, pipeline.isActive());
+    
+    int numChannels = juce::jmin(totalNumInputChannels, buffer.getNumChannels());
+    
+    // keep the dry input flowing through, so a switch to bypass picks up
+    // where the processed audio leaves off
+    delayBypass(buffer, numChannels, false);
+    
+    recorder.pushBlock(buffer, numChannels, chainSettings);
+    
+    if (pipeline.isActive())
+    {
+        pipeline.process(buffer, numChannels, chainSettings);
+    }
+    else
+    {
+        bank.setSettings(chainSettings);
+        
+        if (bank.isOffline())
+        {
+            // the offline profile's worker threads wait on locks, which a
+            // render without a deadline can afford
+            THESIS_RT_ALLOW;
+            bank.process(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+        }
+        else
+        {
+            bank.process(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+        }
+    }
+    
+    bank.setFollowBand(int(followBand->load()) - 1);
+    writeFollowOutput(buffer, bank.getFollowLevel());
+}
+
+void ThesisAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    THESIS_RT_REGION;
+    
+    // The pipeline's worker is let go while bypassed, but the latency stays
+    // what processing reports, and the dry signal is delayed to match it,
+    // so switching bypass neither moves the host's compensation nor shifts
+    // the audio against other tracks.
+    updatePipelineMode(false);
+    updateLatency(int(chainParameters.oversampling->load()), pipelined->load() && ! isNonRealtime());
+    
+    delayBypass(buffer, juce::jmin(getTotalNumInputChannels(), buffer.getNumChannels()), true);
+    writeFollowOutput(buffer, 0.f);
+}
+
+// The input through a delay line of getLatencySamples(); with bypassed
+// false the input is only written, and the buffer left as it is.
+void ThesisAudioProcessor::delayBypass(juce::AudioBuffer<float>& buffer, int numChannels, bool bypassed)
+{
+    const int size = bypassDelay.getNumSamples();
+    
+    if (size == 0)
+        return;
+    
+    const int delay = juce::jmin(getLatencySamples(), size - 1);
+    const int numSamples = buffer.getNumSamples();
+    numChannels = juce::jmin(numChannels, bypassDelay.getNumChannels());
+    
+    for (int chan = 0; chan < numChannels; chan++)
+    {
+        float* line = bypassDelay.getWritePointer(chan);
+        float* data = buffer.getWritePointer(chan);
+        int pos = bypassDelayPos;
+        
+        for (int n = 0; n < numSamples; n++)
+        {
+            line[pos] = data[n];
+            
+            if (bypassed)
+                data[n] = line[pos >= delay ? pos - delay : pos - delay + size];
+            
+            if (++pos == size)
+                pos = 0;
+        }
+    }
+    
+    bypassDelayPos = (bypassDelayPos + numSamples) % size;
+}
+
+// The follow output: the Follow Band's level over the block, ramped from
+// the last block's so it moves without steps.
+void ThesisAudioProcessor::writeFollowOutput(juce::AudioBuffer<float>& buffer, float level)
+{
+    if (getBusCount(false) < 2)
+        return;
+    
+    auto follow = getBusBuffer(buffer, false, 1);
+    
+    if (follow.getNumChannels() == 0)
+    {
+        followLevel = level;
+        return;
+    }
+    
+    float* out = follow.getWritePointer(0);
+    const int numSamples = follow.getNumSamples();
+    
+    for (int n = 0; n < numSamples; n++)
+        out[n] = followLevel + (level - followLevel) * float(n + 1) / float(numSamples);
+    
+    followLevel = level;
+}
+
+void ThesisAudioProcessor::updatePipelineMode(bool shouldPipeline)
+{
+    if (shouldPipeline == pipeline.isActive())
+        return;
+    
+    if (shouldPipeline)
+        pipeline.start();
+    else if (! pipeline.stop())
+        return;     // the worker is mid-block; try again next callback
+}
+
+void ThesisAudioProcessor::updateLatency(int oversampling, bool pipelined)
+{
+    // the pipeline's block and the oversampling filters add up
+    int latency = HarmonicBank::getOversamplingLatency(oversampling);
+    
+    if (pipelined)
+        latency += pipeline.getLatencySamples();
+    
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+bool ThesisAudioProcessor::startCapture(const juce::File& file, bool withAudio)
+{
+    return recorder.start(file, getSampleRate(), getBlockSize(), getTotalNumInputChannels(), withAudio);
+}
+
+ResponseSnapshot ThesisAudioProcessor::getResponseSnapshot()
+{
+    return makeResponseSnapshot(getChainSettings(apvts), getSampleRate(), std::atomic_load(&partialMap));
+}
+
+bool ThesisAudioProcessor::loadPartialMap(const juce::File& file, juce::String* error)
+{
+    std::string reason;
+    auto map = PartialMap::load(file.getFullPathName().toStdString(), &reason);
+    
+    if (map == nullptr)
+    {
+        if (error != nullptr)
+            *error = reason;
+        return false;
+    }
+    
+    setPartialMap(std::move(map));
+    apvts.state.setProperty("PartialMap", file.getFullPathName(), nullptr);
+    
+    return true;
+}
+
+void ThesisAudioProcessor::clearPartialMap()
+{
+    setPartialMap(nullptr);
+    apvts.state.removeProperty("PartialMap", nullptr);
+}
+
+void ThesisAudioProcessor::setPartialMap(std::shared_ptr<const PartialMap> map)
+{
+    // every preset without a map lands here with nullptr; when nothing
+    // changes, don't stall the audio thread for it
+    if (map == std::atomic_load(&partialMap))
+        return;
+    
+    // with the callbacks suspended and the pipeline's worker stopped, the
+    // bank is this thread's while it switches, and the old map is released
+    // here rather than on the audio thread
+    suspendProcessing(true);
+    
+    while (! pipeline.stop())
+        juce::Thread::sleep(1);
+    
+    bank.setPartialMap(map);
+    recorder.setPartialMap(map.get());
+    std::atomic_store(&partialMap, std::move(map));
+    
+    suspendProcessing(false);
+}
+
+//==============================================================================
+bool ThesisAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* ThesisAudioProcessor::createEditor()
+{
+//    return new ThesisAudioProcessorEditor (*this);
+    return new juce::GenericAudioProcessorEditor (*this);
+}
+
+//==============================================================================
+void ThesisAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    // You should use this method to store your parameters in the memory block.
+    // You could do that either as raw data, or use the XML or ValueTree classes
+    // as intermediaries to make it easy to save and load complex data.
+    juce::MemoryOutputStream mos(destData, true);
+    apvts.state.writeToStream(mos);
+}
+
+void ThesisAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    // You should use this method to restore your parameters from this memory block,
+    // whose contents will have been created by the getStateInformation() call.
+    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    if ( tree.isValid() )
+    {
+        apvts.replaceState(tree);
+        
+        // a map that has gone missing leaves the harmonics running, but its
+        // path stays in the state for the next save
+        auto mapPath = tree.getProperty("PartialMap").toString();
+        
+        if (mapPath.isEmpty() || ! loadPartialMap(juce::File(mapPath)))
+            setPartialMap(nullptr);
+    }
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    //==============================================================================
+    timbre = apvts.getRawParameterValue("Timbre");
+    freq = apvts.getRawParameterValue("Center Frequency");
+    q = apvts.getRawParameterValue("Q");
+    
+    //==============================================================================
+    stereoLink = apvts.getRawParameterValue("Stereo Link");
+    quality = apvts.getRawParameterValue("Quality");
+    extendedQuality = apvts.getRawParameterValue("Extended Quality");
+    curve = apvts.getRawParameterValue("Curve");
+    detune = apvts.getRawParameterValue("Detune");
+    oversampling = apvts.getRawParameterValue("Oversampling");
+    
+    //==============================================================================
+    modFreq = apvts.getRawParameterValue("Mod Freq");
+    modDetune = apvts.getRawParameterValue("Mod Detune");
+    modDepth = apvts.getRawParameterValue("Mod Depth");
+    modRate = apvts.getRawParameterValue("Mod Rate");
+    modSpread = apvts.getRawParameterValue("Mod Spread");
+    modRateSpread = apvts.getRawParameterValue("Mod Rate Spread");
+    
+    //==============================================================================
+    governor = apvts.getRawParameterValue("CPU Governor");
+    cpuBudget = apvts.getRawParameterValue("CPU Budget");
+    culling = apvts.getRawParameterValue("Band Culling");
+    engine = apvts.getRawParameterValue("Engine");
+}
+
+ChainSettings ChainParameters::load() const
+{
+    ChainSettings settings;
+    
+    //==============================================================================
+    settings.timbre = timbre->load();
+    settings.freq = freq->load();
+    settings.q = q->load();
+    
+    //==============================================================================
+    settings.stereoLink = stereoLink->load();
+    // "Extended Quality" carries on where Quality's 0..2 stops
+    auto extended = int(extendedQuality->load());
+    settings.quality = extended > 0 ? 2 + extended : int(quality->load());
+    settings.curve = curve->load();
+    settings.detune = detune->load();
+    settings.oversampling = int(oversampling->load());
+    
+    //==============================================================================
+    settings.modFreq = modFreq->load();
+    settings.modDetune = modDetune->load();
+    settings.modDepth = modDepth->load();
+    settings.modRate = modRate->load();
+    settings.modSpread = modSpread->load();
+    settings.modRateSpread = modRateSpread->load();
+    
+    //==============================================================================
+    settings.governor = governor->load();
+    settings.cpuBudget = cpuBudget->load();
+    settings.culling = culling->load();
+    settings.engine = int(engine->load());
+    
+    return settings;
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    return ChainParameters(apvts).load();
+}
+
+void setChainSettings(juce::AudioProcessorValueTreeState& apvts, const ChainSettings& settings)
+{
+    auto set = [&apvts](const juce::String& paramID, float value)
+    {
+        auto* param = apvts.getParameter(paramID);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    };
+    
+    //==============================================================================
+    set("Timbre", settings.timbre);
+    set("Center Frequency", settings.freq);
+    set("Q", settings.q);
+    
+    //==============================================================================
+    set("Stereo Link", settings.stereoLink);
+    set("Quality", float(std::min(settings.quality, 2)));
+    set("Extended Quality", float(std::max(settings.quality - 2, 0)));
+    set("Curve", settings.curve);
+    set("Detune", settings.detune);
+    set("Oversampling", float(settings.oversampling));
+    
+    //==============================================================================
+    set("Mod Freq", settings.modFreq ? 1.f : 0.f);
+    set("Mod Detune", settings.modDetune ? 1.f : 0.f);
+    set("Mod Depth", settings.modDepth);
+    set("Mod Rate", settings.modRate);
+    set("Mod Spread", settings.modSpread);
+    set("Mod Rate Spread", settings.modRateSpread);
+    
+    //==============================================================================
+    set("CPU Governor", settings.governor ? 1.f : 0.f);
+    set("CPU Budget", settings.cpuBudget);
+    set("Band Culling", settings.culling ? 1.f : 0.f);
+    set("Engine", float(settings.engine));
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout
+    ThesisAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    
+    //==============================================================================
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Timbre",
+                                                           "Timbre",
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.05f, 1.f),
+                                                           0.5f));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Center Frequency",
+                                                           "Center Frequency",
+                                                           juce::NormalisableRange<float>(20.f, 10000.f, 1.f, 0.25f),
+                                                           100.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Q",
+                                                           "Q",
+                                                           juce::NormalisableRange<float>(1.f, 100.f, 0.1f, 1.f),
+                                                           20.f));
+        
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Detune",
+                                                           "Detune",
+                                                           juce::NormalisableRange<float>(0.5f, 2.f, 0.01f, 1.f),
+                                                           1.f));
+        
+    //==============================================================================
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Stereo Link",
+                                                           "Stereo Link",
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.05f, 1.f),
+                                                           1.f));
+        
+    layout.add(std::make_unique<juce::AudioParameterInt>("Quality",
+                                                         "Quality",
+                                                         0, 2, 1));
+    
+    // Quality keeps its 0..2 range so saved sessions and automation still
+    // mean what they did; the levels past it are a separate switch
+    juce::StringArray extendedQualities { "Off" };
+    
+    for (int quality = 3; quality <= MAX_QUALITY; ++quality)
+        extendedQualities.add(juce::String(HarmonicBank::getNumHarmonics(quality)) + " Harmonics");
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Extended Quality",
+                                                            "Extended Quality",
+                                                            extendedQualities,
+                                                            0));
+        
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Curve",
+                                                           "Curve",
+                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.1f, 0.25f),
+                                                           1.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling",
+                                                            "Oversampling",
+                                                            juce::StringArray { "Off", "2x", "4x" },
+                                                            0));
+        
+    //==============================================================================
+    layout.add(std::make_unique<juce::AudioParameterBool>("Mod Freq", "Mod Freq", false));
+        
+    layout.add(std::make_unique<juce::AudioParameterBool>("Mod Detune", "Mod Detune", false));
+        
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Mod Depth",
+                                                           "Mod Depth",
+                                                           juce::NormalisableRange<float>(0.f, 100.f, 0.1f, 1.f),
+                                                           1.f));
+        
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Mod Rate",
+                                                           "Mod Rate",
+                                                           juce::NormalisableRange<float>(0.1f, 20.f, 0.1f, 1.f),
+                                                           1.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Mod Spread",
+                                                           "Mod Spread",
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           0.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Mod Rate Spread",
+                                                           "Mod Rate Spread",
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f, 1.f),
+                                                           0.f));
+    
+    //==============================================================================
+    layout.add(std::make_unique<juce::AudioParameterBool>("CPU Governor", "CPU Governor", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("CPU Budget",
+                                                           "CPU Budget",
+                                                           juce::NormalisableRange<float>(5.f, 100.f, 1.f, 1.f),
+                                                           25.f));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>("Pipelined", "Pipelined", false));
+    
+    // opt-in: it only saves on sparse material, and breaks even on dense
+    // (see benchmarkCulling)
+    layout.add(std::make_unique<juce::AudioParameterBool>("Band Culling", "Band Culling", false));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Engine",
+                                                            "Engine",
+                                                            juce::StringArray { "SVF", "Modal" },
+                                                            ENGINE_SVF));
+    
+    // the harmonic (1 is the fundamental) whose level the Follow output carries
+    layout.add(std::make_unique<juce::AudioParameterInt>("Follow Band",
+                                                         "Follow Band",
+                                                         1, MAX_HARM, 1));
+    
+    return layout;
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new ThesisAudioProcessor();
+}
@@ -1,125 +1,142 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "Modulator.h"
-
-#define LEFT_CHANNEL    0
-#define RIGHT_CHANNEL   1
-#define NUM_HARM        200
-
-
-struct ChainSettings
-{
-    /* Main Section */
-    float timbre {0};
-    float freq {0};
-    float q {0};
-    
-    /* Secondary Section */
-    float stereoLink {0};
-    int quality {0};
-    float curve {0};
-    float detune {0};
-    
-    /* Mod Section */
-    bool modFreq {0};
-    bool modDetune {0};
-    float modRate {0};
-    float modDepth {0};
-
-    float oddGain {0};
-    float evenGain {0};
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-//==============================================================================
-/**
-*/
-class ThesisAudioProcessor  : public juce::AudioProcessor
-{
-public:
-    //==============================================================================
-    ThesisAudioProcessor();
-    ~ThesisAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-    
-    static juce::AudioProcessorValueTreeState::ParameterLayout
-        createParameterLayout();
-    juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
-    
-    Modulator mod;
-    
-    std::vector<float> modVector;
-
-private:
-    void processWithMod(juce::AudioBuffer<float>& buffer, const ChainSettings& chainSettings, float* modVal, int harm);
-    void processNoMod(juce::AudioBuffer<float>& buffer, int harm);
-    
-    float wrap(float x, int sampleRate);
-    float getCurFreq(const ChainSettings& chainSettings, int harm);
-    
-    using SVFilter = juce::dsp::StateVariableTPTFilter<float>;
-    
-    using Gain = juce::dsp::Gain<float>;
-    
-    using BPChain = juce::dsp::ProcessorChain<SVFilter, Gain, Gain>;
-    
-    BPChain leftChain[NUM_HARM], rightChain[NUM_HARM];
-    
-    enum BPChainPositions
-    {
-        BPFilter,
-        CurveGain,
-        OddEvenGain
-    };
-    
-    void updateAll();
-    bool updateSVFilter (const ChainSettings& chainSettings, int i);
-    void updateCurveGain (const ChainSettings& chainSettings, int i);
-    void updateOddEvenGain (const ChainSettings& chainSettings, int i);
-    
-
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThesisAudioProcessor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "HarmonicBank.h"
+#include "BankResponse.h"
+#include "PipelineRunner.h"
+#include "SessionRecorder.h"
+#include "RealtimeCheck.h"
+
+#define LEFT_CHANNEL    0
+#define RIGHT_CHANNEL   1
+
+using ChainSettings = BankSettings;
+
+// The parameters behind ChainSettings, looked up once: building the
+// juce::String IDs allocates, so the audio thread only ever uses load().
+struct ChainParameters
+{
+    ChainParameters(juce::AudioProcessorValueTreeState& apvts);
+    ChainSettings load() const;
+    
+    std::atomic<float> *timbre, *freq, *q;
+    std::atomic<float> *stereoLink, *quality, *extendedQuality, *curve, *detune, *oversampling;
+    std::atomic<float> *modFreq, *modDetune, *modDepth, *modRate, *modSpread, *modRateSpread;
+    std::atomic<float> *governor, *cpuBudget, *culling, *engine;
+};
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+void setChainSettings(juce::AudioProcessorValueTreeState& apvts, const ChainSettings& settings);
+
+//==============================================================================
+/**
+*/
+class ThesisAudioProcessor  : public juce::AudioProcessor
+{
+public:
+    //==============================================================================
+    ThesisAudioProcessor();
+    ~ThesisAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+   #endif
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+    
+    static juce::AudioProcessorValueTreeState::ParameterLayout
+        createParameterLayout();
+    juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
+    
+    // what the CPU governor is doing right now; safe to poll from any thread
+    int getGovernorHarmonics() const { return bank.getGovernorHarmonics(); }
+    float getGovernorBudgetUse() const { return bank.getGovernorBudgetUse(); }
+    int getNumCulledBands() const { return bank.getNumCulledBands(); }
+    float getAverageCulledBands() const { return bank.getAverageCulledBands(); }
+
+    // which kernel build prepareToPlay picked, and its measured cost
+    const char* getKernelName() const { return bank.getKernelName(); }
+    float getKernelThroughput() const { return bank.getKernelThroughput(); }
+
+    // microseconds the last prepareToPlay took, and the bank's share of it
+    float getPrepareMicros() const { return prepareMicros.load(); }
+    float getBankPrepareMicros() const { return bank.getPrepareMicros(); }
+
+    // the current parameters' coefficients, for computeResponse on any thread
+    ResponseSnapshot getResponseSnapshot();
+    
+    // each band's RMS and peak over the last block, and the Follow Band's
+    // RMS (see BandMeters.h); safe to poll from any thread
+    int readBandMeters(float* rms, float* peak, int maxBands) const { return bank.readBandMeters(rms, peak, maxBands); }
+    float getFollowLevel() const { return bank.getFollowLevel(); }
+
+    // Runs the partials in file in place of the harmonic series (see
+    // PartialMap.h) and keeps its path in the saved state; message thread.
+    // Returns false, with the reason in error, if it is not a valid map.
+    bool loadPartialMap(const juce::File& file, juce::String* error = nullptr);
+    void clearPartialMap();
+
+    // records every block's size, settings and (optionally) input to file,
+    // for replaySession; call from the message thread once prepared
+    bool startCapture(const juce::File& file, bool withAudio);
+    void stopCapture() { recorder.stop(); }
+    
+private:
+    void updatePipelineMode(bool shouldPipeline);
+    void updateLatency(int oversampling, bool pipelined);
+    void setPartialMap(std::shared_ptr<const PartialMap> map);
+    void writeFollowOutput(juce::AudioBuffer<float>& buffer, float level);
+    void delayBypass(juce::AudioBuffer<float>& buffer, int numChannels, bool bypassed);
+    
+    ChainParameters chainParameters {apvts};
+    std::atomic<float>* pipelined {apvts.getRawParameterValue("Pipelined")};
+    std::atomic<float>* followBand {apvts.getRawParameterValue("Follow Band")};
+    float followLevel {0};      // where the follow output's last block ended
+    juce::AudioBuffer<float> bypassDelay;   // the dry input, for processBlockBypassed
+    int bypassDelayPos {0};
+    std::atomic<float> prepareMicros {0};
+    
+    HarmonicBank bank;
+    PipelineRunner pipeline {bank};
+    std::shared_ptr<const PartialMap> partialMap;   // the bank's, for getResponseSnapshot
+    SessionRecorder recorder;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThesisAudioProcessor)
+};
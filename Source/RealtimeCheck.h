@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Created: 20 Oct 2026 4:05:41pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/*
+    Debug/CI mode that catches audio-thread code which can block. Build with
+    THESIS_RT_CHECK=1 and every heap allocation or free, mutex lock,
+    condition wait and blocking read/write/sleep made while a
+    THESIS_RT_REGION is alive on the current thread is reported to stderr
+    with a stack trace, or aborts the process if the check is fatal.
+
+    The checker itself is Tests/RealtimeCheck.cpp, which only the test
+    targets compile (ThesisTests defines THESIS_RT_CHECK=1); the plugin
+    never links it and only ever sees the empty macros. operator new/delete,
+    the aligned overloads included, are replaced everywhere. On Linux these
+    are interposed as well, which works because the checker is linked into
+    the executable:
+        malloc, calloc, realloc, free, aligned_alloc, posix_memalign, memalign
+        pthread_mutex_lock, pthread_cond_wait, pthread_cond_timedwait,
+        pthread_cond_clockwait
+        open, read, write, poll, fsync, usleep, nanosleep
+
+    THESIS_RT_ALLOW marks the few deliberate exceptions (e.g. signalling a
+    worker), so they do not drown out real problems. Without THESIS_RT_CHECK
+    both macros are empty and nothing is ever reported.
+*/
+
+#ifndef THESIS_RT_CHECK
+ #define THESIS_RT_CHECK 0
+#endif
+
+#if THESIS_RT_CHECK
+class ScopedRealtimeRegion
+{
+public:
+    ScopedRealtimeRegion();
+    ~ScopedRealtimeRegion();
+};
+
+class ScopedRealtimeAllow
+{
+public:
+    ScopedRealtimeAllow();
+    ~ScopedRealtimeAllow();
+};
+
+ #define THESIS_RT_REGION   ScopedRealtimeRegion realtimeRegion_
+ #define THESIS_RT_ALLOW    ScopedRealtimeAllow realtimeAllow_
+#else
+ #define THESIS_RT_REGION
+ #define THESIS_RT_ALLOW
+#endif
+
+// violations reported since the last reset, across all threads
+int getRealtimeViolationCount();
+void resetRealtimeViolations();
+
+// abort on the first violation instead of reporting and carrying on
+void setRealtimeCheckFatal(bool shouldAbort);
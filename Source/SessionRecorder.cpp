@@ -0,0 +1,451 @@
+/*
+  ==============================================================================
+
+    SessionRecorder.cpp
+    Created: 20 Oct 2026 1:47:19pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "SessionRecorder.h"
+#include "PluginProcessor.h"
+
+#define CAPTURE_VERSION         5       // 2 added the engine, 3 band culling, 4 oversampling, 5 the partial map
+#define CAPTURE_MAP_RECORD      -1      // in place of a block's numSamples
+#define CAPTURE_AUDIO_SECONDS   2       // audio the writer may fall behind by
+#define CAPTURE_MAX_BLOCK       (1 << 20)
+
+static const char captureMagic[4] = { 'T', 'H', 'S', 'C' };
+
+static void writeSettings(juce::OutputStream& out, const BankSettings& settings)
+{
+    out.writeFloat(settings.timbre);
+    out.writeFloat(settings.freq);
+    out.writeFloat(settings.q);
+
+    out.writeFloat(settings.stereoLink);
+    out.writeInt(settings.quality);
+    out.writeFloat(settings.curve);
+    out.writeFloat(settings.detune);
+
+    out.writeBool(settings.modFreq);
+    out.writeBool(settings.modDetune);
+    out.writeFloat(settings.modRate);
+    out.writeFloat(settings.modDepth);
+    out.writeFloat(settings.modSpread);
+    out.writeFloat(settings.modRateSpread);
+
+    out.writeBool(settings.governor);
+    out.writeFloat(settings.cpuBudget);
+    out.writeInt(settings.engine);
+    out.writeBool(settings.culling);
+    out.writeInt(settings.oversampling);
+}
+
+static void readSettings(juce::InputStream& in, int version, BankSettings& settings)
+{
+    settings.timbre = in.readFloat();
+    settings.freq = in.readFloat();
+    settings.q = in.readFloat();
+
+    settings.stereoLink = in.readFloat();
+    settings.quality = in.readInt();
+    settings.curve = in.readFloat();
+    settings.detune = in.readFloat();
+
+    settings.modFreq = in.readBool();
+    settings.modDetune = in.readBool();
+    settings.modRate = in.readFloat();
+    settings.modDepth = in.readFloat();
+    settings.modSpread = in.readFloat();
+    settings.modRateSpread = in.readFloat();
+
+    settings.governor = in.readBool();
+    settings.cpuBudget = in.readFloat();
+
+    if (version >= 2)
+        settings.engine = in.readInt();
+
+    if (version >= 3)
+        settings.culling = in.readBool();
+
+    if (version >= 4)
+        settings.oversampling = in.readInt();
+}
+
+//==============================================================================
+SessionRecorder::SessionRecorder()
+    : juce::Thread("Thesis capture writer")
+{
+    // generation 0: the harmonics
+    maps.emplace_back();
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+bool SessionRecorder::start(const juce::File& file, double sampleRate, int maxBlockSize, int newNumChannels, bool shouldCaptureAudio)
+{
+    stop();
+
+    if (sampleRate <= 0 || maxBlockSize <= 0 || newNumChannels <= 0)
+        return false;
+
+    file.deleteFile();
+    stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (stream->failedToOpen())
+    {
+        stream.reset();
+        return false;
+    }
+
+    numChannels = newNumChannels;
+    withAudio = shouldCaptureAudio;
+
+    stream->write(captureMagic, sizeof(captureMagic));
+    stream->writeInt(CAPTURE_VERSION);
+    stream->writeDouble(sampleRate);
+    stream->writeInt(maxBlockSize);
+    stream->writeInt(numChannels);
+    stream->writeInt(withAudio ? 1 : 0);
+
+    records.resize(size_t(recordFifo.getTotalSize()));
+    recordFifo.reset();
+
+    int ringSize = withAudio ? juce::jmax(int(sampleRate) * CAPTURE_AUDIO_SECONDS, maxBlockSize) + 1 : 1;
+    audioFifo.setTotalSize(ringSize);
+    audioRing.setSize(numChannels, ringSize);
+
+    droppedBlocks = 0;
+
+    // the first block writes whichever map it ran with
+    writtenGeneration = -1;
+
+    startThread();
+    capturing = true;
+
+    return true;
+}
+
+void SessionRecorder::stop()
+{
+    if (stream == nullptr)
+        return;
+
+    // pushBlock sets pushing before it checks capturing, so once capturing
+    // is clear and pushing is not, the FIFOs are no longer being written
+    capturing = false;
+    while (pushing)
+        juce::Thread::yield();
+
+    stopThread(2000);
+
+    writePending();
+    stream->flush();
+    stream.reset();
+}
+
+void SessionRecorder::setPartialMap(const PartialMap* map)
+{
+    MapRecord record;
+
+    if (map != nullptr)
+    {
+        record.path = juce::String::fromUTF8(map->getPath().c_str());
+        record.hash = juce::int64(map->getContentHash());
+    }
+
+    const juce::ScopedLock lock(mapLock);
+
+    maps.push_back(record);
+    mapGeneration = int(maps.size()) - 1;
+}
+
+//==============================================================================
+void SessionRecorder::pushBlock(const juce::AudioBuffer<float>& buffer, int numChans, const BankSettings& settings)
+{
+    if (! capturing)
+        return;
+
+    pushing = true;
+
+    if (capturing)
+    {
+        int numSamples = buffer.getNumSamples();
+        int start1, size1, start2, size2;
+
+        numChans = juce::jmin(numChans, buffer.getNumChannels());
+
+        if (recordFifo.getFreeSpace() < 1 || (withAudio && audioFifo.getFreeSpace() < numSamples))
+        {
+            droppedBlocks++;
+        }
+        else
+        {
+            // the audio goes in first, so the writer never sees a record without it
+            if (withAudio)
+            {
+                audioFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+                for (int chan = 0; chan < numChannels; chan++)
+                {
+                    if (chan < numChans)
+                    {
+                        audioRing.copyFrom(chan, start1, buffer, chan, 0, size1);
+                        if (size2 > 0)
+                            audioRing.copyFrom(chan, start2, buffer, chan, size1, size2);
+                    }
+                    else
+                    {
+                        audioRing.clear(chan, start1, size1);
+                        if (size2 > 0)
+                            audioRing.clear(chan, start2, size2);
+                    }
+                }
+                audioFifo.finishedWrite(size1 + size2);
+            }
+
+            recordFifo.prepareToWrite(1, start1, size1, start2, size2);
+            records[size_t(start1)].numSamples = numSamples;
+            records[size_t(start1)].mapGeneration = mapGeneration.load(std::memory_order_relaxed);
+            records[size_t(start1)].settings = settings;
+            recordFifo.finishedWrite(1);
+        }
+    }
+
+    pushing = false;
+}
+
+//==============================================================================
+void SessionRecorder::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(20);
+        writePending();
+    }
+}
+
+void SessionRecorder::writePending()
+{
+    int start1, size1, start2, size2;
+    int numRecords = recordFifo.getNumReady();
+
+    for (int i = 0; i < numRecords; i++)
+    {
+        recordFifo.prepareToRead(1, start1, size1, start2, size2);
+        BlockRecord record = records[size_t(start1)];
+        recordFifo.finishedRead(1);
+
+        if (record.mapGeneration != writtenGeneration)
+        {
+            MapRecord map;
+
+            {
+                const juce::ScopedLock lock(mapLock);
+                map = maps[size_t(record.mapGeneration)];
+            }
+
+            stream->writeInt(CAPTURE_MAP_RECORD);
+            stream->writeString(map.path);
+            stream->writeInt64(map.hash);
+
+            writtenGeneration = record.mapGeneration;
+        }
+
+        stream->writeInt(record.numSamples);
+        writeSettings(*stream, record.settings);
+
+        if (withAudio)
+        {
+            audioFifo.prepareToRead(record.numSamples, start1, size1, start2, size2);
+            for (int chan = 0; chan < numChannels; chan++)
+            {
+                stream->write(audioRing.getReadPointer(chan, start1), size_t(size1) * sizeof(float));
+                if (size2 > 0)
+                    stream->write(audioRing.getReadPointer(chan, start2), size_t(size2) * sizeof(float));
+            }
+            audioFifo.finishedRead(size1 + size2);
+        }
+    }
+}
+
+//==============================================================================
+ReplayReport replaySession(const juce::File& file)
+{
+    ReplayReport report;
+    juce::FileInputStream in(file);
+
+    if (in.failedToOpen())
+    {
+        report.error = "cannot open " + file.getFullPathName();
+        return report;
+    }
+
+    char magic[sizeof(captureMagic)];
+    if (in.read(magic, sizeof(magic)) != int(sizeof(magic)) || std::memcmp(magic, captureMagic, sizeof(magic)) != 0)
+    {
+        report.error = "not a capture file";
+        return report;
+    }
+
+    int version = in.readInt();
+    if (version < 1 || version > CAPTURE_VERSION)
+    {
+        report.error = "unsupported capture version " + juce::String(version);
+        return report;
+    }
+
+    report.sampleRate = in.readDouble();
+    report.maxBlockSize = in.readInt();
+    int numChannels = in.readInt();
+    report.hadAudio = in.readInt() != 0;
+
+    if (report.sampleRate <= 0 || report.maxBlockSize <= 0 || report.maxBlockSize > CAPTURE_MAX_BLOCK
+        || numChannels <= 0 || numChannels > 64)
+    {
+        report.error = "corrupt capture header";
+        return report;
+    }
+
+    ThesisAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails(report.sampleRate, report.maxBlockSize);
+    processor.prepareToPlay(report.sampleRate, report.maxBlockSize);
+
+    int numBufferChannels = juce::jmax(numChannels, processor.getTotalNumInputChannels());
+    juce::AudioBuffer<float> buffer(numBufferChannels, report.maxBlockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(0x7e515);
+
+    report.loaded = true;
+
+    for (;;)
+    {
+        if (in.getNumBytesRemaining() < 4)
+            break;
+
+        int numSamples = in.readInt();
+
+        // the blocks from here on ran with this map
+        if (numSamples == CAPTURE_MAP_RECORD && version >= 5)
+        {
+            auto path = in.readString();
+            auto hash = in.readInt64();
+
+            if (path.isEmpty())
+            {
+                processor.clearPartialMap();
+                continue;
+            }
+
+            std::string reason;
+            auto map = PartialMap::load(path.toStdString(), &reason);
+
+            if (map == nullptr || ! processor.loadPartialMap(juce::File(path)))
+            {
+                report.warning = "cannot load partial map " + path + ": " + juce::String(reason);
+                processor.clearPartialMap();
+            }
+            else if (juce::int64(map->getContentHash()) != hash)
+            {
+                report.warning = "partial map " + path + " has changed since the capture";
+            }
+
+            continue;
+        }
+
+        if (numSamples <= 0 || numSamples > CAPTURE_MAX_BLOCK)
+        {
+            report.error = "corrupt block " + juce::String(report.blockSizes.size());
+            break;
+        }
+
+        BankSettings settings;
+        readSettings(in, version, settings);
+
+        // timing-dependent behaviour would make replays differ
+        settings.governor = false;
+
+        // allocations stay outside the timed region
+        if (numSamples > buffer.getNumSamples())
+            buffer.setSize(numBufferChannels, numSamples, false, false, true);
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numBufferChannels, numSamples);
+        block.clear();
+
+        if (report.hadAudio)
+        {
+            auto bytes = juce::int64(numSamples) * juce::int64(sizeof(float));
+            if (in.getNumBytesRemaining() < bytes * numChannels)
+            {
+                report.error = "capture ends mid-block";
+                break;
+            }
+
+            for (int chan = 0; chan < numChannels; chan++)
+                in.read(block.getWritePointer(chan), int(bytes));
+        }
+        else
+        {
+            for (int chan = 0; chan < numChannels; chan++)
+                for (int i = 0; i < numSamples; i++)
+                    block.setSample(chan, i, random.nextFloat() - 0.5f);
+        }
+
+        setChainSettings(processor.apvts, settings);
+
+        auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(block, midi);
+        double micros = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6;
+
+        if (micros > report.maxMicros)
+        {
+            report.maxMicros = micros;
+            report.slowestBlock = int(report.blockMicros.size());
+        }
+
+        report.totalMicros += micros;
+        report.blockSizes.push_back(numSamples);
+        report.blockMicros.push_back(micros);
+    }
+
+    processor.releaseResources();
+
+    return report;
+}
+
+juce::String describeReplay(const ReplayReport& report)
+{
+    if (! report.loaded)
+        return "replay failed: " + report.error;
+
+    int numBlocks = int(report.blockMicros.size());
+
+    juce::String text;
+    text << numBlocks << " blocks at " << report.sampleRate << " Hz"
+         << (report.hadAudio ? " (recorded audio)" : " (noise)")
+         << ", total " << juce::String(report.totalMicros / 1000.0, 2) << " ms";
+
+    if (numBlocks > 0)
+    {
+        int slowest = report.slowestBlock;
+        double budget = report.blockSizes[size_t(slowest)] / report.sampleRate * 1.0e6;
+
+        text << ", mean " << juce::String(report.totalMicros / numBlocks, 1) << " us"
+             << ", slowest block " << slowest
+             << " (" << report.blockSizes[size_t(slowest)] << " samples) "
+             << juce::String(report.maxMicros, 1) << " us = "
+             << juce::String(100.0 * report.maxMicros / budget, 1) << "% of its period";
+    }
+
+    if (report.error.isNotEmpty())
+        text << " [" << report.error << "]";
+
+    if (report.warning.isNotEmpty())
+        text << " [" << report.warning << "]";
+
+    return text;
+}
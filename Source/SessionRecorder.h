@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    SessionRecorder.h
+    Created: 20 Oct 2026 1:47:19pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "HarmonicBank.h"
+
+/*
+    Capture and replay of what the audio thread saw, for reproducing CPU
+    spikes offline. A capture records every block's size and ChainSettings,
+    the partial map the blocks ran with, and optionally their input audio.
+
+    The audio thread only copies into lock-free FIFOs (juce::AbstractFifo);
+    a writer thread drains them to the file. If the writer falls behind, the
+    blocks that do not fit are dropped whole and counted, so everything in
+    the file is still consistent.
+
+    File layout (little-endian):
+        "THSC", int version, double sampleRate, int maxBlockSize,
+        int numChannels, int hasAudio
+        then per block: int numSamples, settings (see writeSettings),
+        and numChannels * numSamples floats, channel by channel, if hasAudio
+        and ahead of the first block and of every block whose partial map
+        differs from the last one's: int -1, the map's path (a JUCE string,
+        empty for the harmonics) and its int64 content hash
+*/
+
+class SessionRecorder  : private juce::Thread
+{
+public:
+    SessionRecorder();
+    ~SessionRecorder() override;
+
+    // message thread
+    bool start(const juce::File& file, double sampleRate, int maxBlockSize, int numChannels, bool withAudio);
+    void stop();
+
+    // audio thread: records the block as it arrives, before processing
+    void pushBlock(const juce::AudioBuffer<float>& buffer, int numChannels, const BankSettings& settings);
+
+    // message thread, whether capturing or not: the partial map the blocks
+    // pushed from now on run with, or nullptr for the harmonics
+    void setPartialMap(const PartialMap* map);
+
+    bool isCapturing() const { return capturing.load(); }
+    int getNumDroppedBlocks() const { return droppedBlocks.load(); }
+
+private:
+    struct BlockRecord
+    {
+        int numSamples {0};
+        int mapGeneration {0};
+        BankSettings settings;
+    };
+
+    struct MapRecord
+    {
+        juce::String path;
+        juce::int64 hash {0};
+    };
+
+    void run() override;
+    void writePending();
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+
+    juce::AbstractFifo recordFifo {512}, audioFifo {1};
+    std::vector<BlockRecord> records;
+    juce::AudioBuffer<float> audioRing;
+
+    std::atomic<bool> capturing {false};
+    std::atomic<bool> pushing {false};
+    std::atomic<int> droppedBlocks {0};
+
+    // every map set so far, by generation; the audio thread only reads the
+    // generation, the writer thread looks it up under the lock
+    std::vector<MapRecord> maps;
+    juce::CriticalSection mapLock;
+    std::atomic<int> mapGeneration {0};
+    int writtenGeneration {-1};
+
+    int numChannels {0};
+    bool withAudio {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SessionRecorder)
+};
+
+//==============================================================================
+struct ReplayReport
+{
+    bool loaded {false};
+    juce::String error;
+
+    double sampleRate {0};
+    int maxBlockSize {0};
+    bool hadAudio {false};
+
+    // a recorded partial map that is missing (the replay runs the harmonics
+    // in its place) or has changed since the capture
+    juce::String warning;
+
+    std::vector<int> blockSizes;
+    std::vector<double> blockMicros;    // processBlock time per recorded block
+
+    double totalMicros {0};
+    double maxMicros {0};
+    int slowestBlock {-1};
+};
+
+// Feeds a capture back through a fresh ThesisAudioProcessor, block by block
+// with the recorded sizes, settings and partial maps (loaded again from
+// their paths, between blocks), timing each processBlock. Captures
+// without audio are driven with seeded noise. The governor is held off and
+// the pipeline is never used, so two replays of one file do identical work.
+ReplayReport replaySession(const juce::File& file);
+
+juce::String describeReplay(const ReplayReport& report);
@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    SharedTables.cpp
+    Created: 19 Oct 2026 11:36:07am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "SharedTables.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+static const double pi = 3.141592653589793238463;
+
+// close to nyquist tan() is steep enough that the direct call is the better deal
+static const double tanTableLimit = 0.45;
+
+float BankTables::tanWarp(float freq, double sampleRate) const
+{
+    double x = freq / sampleRate;
+
+    if (x >= tanTableLimit)
+        return float(std::tan(pi * x));
+
+    // tan(a + b) from the nearest table entry a and a short series for the
+    // small remainder b; the high-Q bands need this to stay within float
+    // rounding of std::tan, which plain interpolation does not
+    int i = int(x * 2.0 * TAN_TABLE_SIZE + 0.5);
+    double b = pi * x - pi * 0.5 * i / TAN_TABLE_SIZE;
+    double tanA = tanTable[size_t(i)];
+    double tanB = b + b * b * b / 3.0;
+
+    return float((tanA + tanB) / (1.0 - tanA * tanB));
+}
+
+//==============================================================================
+bool CoeffKey::operator== (const CoeffKey& other) const
+{
+    return sampleRate == other.sampleRate
+        && freq == other.freq
+        && q == other.q
+        && curve == other.curve
+        && detune == other.detune
+        && timbre == other.timbre
+        && quality == other.quality
+        && engine == other.engine
+        && oversampling == other.oversampling
+        && partials == other.partials;
+}
+
+size_t CoeffKeyHash::operator() (const CoeffKey& key) const
+{
+    size_t hash = std::hash<double>()(key.sampleRate);
+
+    auto combine = [&hash](size_t value)
+    {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    };
+
+    combine(std::hash<float>()(key.freq));
+    combine(std::hash<float>()(key.q));
+    combine(std::hash<float>()(key.curve));
+    combine(std::hash<float>()(key.detune));
+    combine(std::hash<float>()(key.timbre));
+    combine(std::hash<int>()(key.quality));
+    combine(std::hash<int>()(key.engine));
+    combine(std::hash<int>()(key.oversampling));
+    combine(std::hash<uint32_t>()(key.partials));
+
+    return hash;
+}
+
+void CoeffSet::resize(int numHarmonics)
+{
+    // fresh vectors, so a smaller set gives the memory back
+    const size_t n = size_t(numHarmonics);
+
+    g = std::vector<float>(n, 0.f);
+    R2 = std::vector<float>(n, 0.f);
+    h = std::vector<float>(n, 0.f);
+    cosR = std::vector<float>(n, 0.f);
+    sinR = std::vector<float>(n, 0.f);
+    drive = std::vector<float>(n, 0.f);
+    gain = std::vector<float>(n, 0.f);
+    octave = std::vector<int>(n, 0);
+    oversample = std::vector<int>(n, 1);
+    numActive = 0;
+}
+
+void CoeffSet::copyActive(const CoeffSet& other)
+{
+    const size_t n = size_t(other.numActive);
+
+    std::copy(other.g.begin(), other.g.begin() + n, g.begin());
+    std::copy(other.R2.begin(), other.R2.begin() + n, R2.begin());
+    std::copy(other.h.begin(), other.h.begin() + n, h.begin());
+    std::copy(other.cosR.begin(), other.cosR.begin() + n, cosR.begin());
+    std::copy(other.sinR.begin(), other.sinR.begin() + n, sinR.begin());
+    std::copy(other.drive.begin(), other.drive.begin() + n, drive.begin());
+    std::copy(other.gain.begin(), other.gain.begin() + n, gain.begin());
+    std::copy(other.octave.begin(), other.octave.begin() + n, octave.begin());
+    std::copy(other.oversample.begin(), other.oversample.begin() + n, oversample.begin());
+
+    numActive = other.numActive;
+    engine = other.engine;
+}
+
+//==============================================================================
+SharedTables& SharedTables::getInstance()
+{
+    static SharedTables instance;
+    return instance;
+}
+
+std::shared_ptr<const BankTables> SharedTables::acquireTables(int numHarmonics)
+{
+    auto& instance = getInstance();
+    std::lock_guard<std::mutex> guard(instance.lock);
+
+    if (auto existing = instance.tables[numHarmonics].lock())
+        return existing;
+
+    auto built = std::make_shared<BankTables>();
+    built->numHarmonics = numHarmonics;
+
+    built->tanTable.resize(TAN_TABLE_SIZE);
+    for (int i = 0; i < TAN_TABLE_SIZE; i++)
+        built->tanTable[size_t(i)] = std::tan(pi * 0.5 * i / TAN_TABLE_SIZE);
+
+    built->logQScale.resize(size_t(numHarmonics));
+    built->logCurve.resize(size_t(numHarmonics));
+
+    for (int h = 0; h < numHarmonics; h++)
+    {
+        built->logQScale[size_t(h)] = std::log(float(h) / 2.f + 1.f);
+        built->logCurve[size_t(h)] = std::log((-1.f / float(numHarmonics)) * float(h) + 1.f);
+    }
+
+    instance.tables[numHarmonics] = built;
+
+    return built;
+}
+
+std::shared_ptr<const CoeffSet> SharedTables::findCoefficients(const CoeffKey& key, bool wait)
+{
+    auto& instance = getInstance();
+    std::unique_lock<std::mutex> guard(instance.lock, std::defer_lock);
+
+    if (wait)
+        guard.lock();
+    else if (! guard.try_lock())
+        return nullptr;
+
+    auto found = instance.coefficients.find(key);
+
+    if (found == instance.coefficients.end())
+        return nullptr;
+
+    return found->second;
+}
+
+std::shared_ptr<const CoeffSet> SharedTables::publishCoefficients(const CoeffKey& key, const CoeffSet& coeffs)
+{
+    auto& instance = getInstance();
+    std::lock_guard<std::mutex> guard(instance.lock);
+
+    // a set only the cache still references belongs to settings nobody runs any more
+    for (auto it = instance.coefficients.begin(); it != instance.coefficients.end();)
+    {
+        if (it->second.use_count() == 1 && ! (it->first == key))
+            it = instance.coefficients.erase(it);
+        else
+            ++it;
+    }
+
+    auto& entry = instance.coefficients[key];
+
+    if (entry == nullptr)
+        entry = std::make_shared<const CoeffSet>(coeffs);
+
+    return entry;
+}
+
+int SharedTables::getNumCachedCoefficientSets()
+{
+    auto& instance = getInstance();
+    std::lock_guard<std::mutex> guard(instance.lock);
+
+    return int(instance.coefficients.size());
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    SharedTables.h
+    Created: 19 Oct 2026 11:36:07am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#define TAN_TABLE_SIZE  4096
+
+/*
+    Process-wide, reference-counted tables shared by every HarmonicBank.
+
+    BankTables holds the read-only lookup tables the coefficient update uses
+    in place of per-band tan/pow calls. The tan table is indexed by f / fs,
+    so one table serves every sample rate.
+
+    Coefficient sets for unmodulated settings are cached by CoeffKey, so
+    instances running the same settings at the same rate point at a single
+    read-only copy. Lookups from the audio thread only try the lock and
+    never allocate; new sets are published from prepare().
+*/
+
+struct BankTables
+{
+    int numHarmonics {0};
+
+    std::vector<double> tanTable;   // tan(pi * x), x = 0 .. 0.5 in TAN_TABLE_SIZE steps
+    std::vector<float> logQScale;   // log(h / 2 + 1), for the per-band Q
+    std::vector<float> logCurve;    // log(1 - h / numHarmonics), for the curve gain
+
+    // tan(pi * freq / sampleRate)
+    float tanWarp(float freq, double sampleRate) const;
+};
+
+struct CoeffKey
+{
+    double sampleRate {0};
+    float freq {0};
+    float q {0};
+    float curve {0};
+    float detune {0};
+    float timbre {0};
+    int quality {0};
+    int engine {0};
+    int oversampling {0};
+    uint32_t partials {0};          // PartialMap::getId, or 0 for the harmonic series
+
+    bool operator== (const CoeffKey& other) const;
+};
+
+struct CoeffKeyHash
+{
+    size_t operator() (const CoeffKey& key) const;
+};
+
+struct CoeffSet
+{
+    std::vector<float> g;       // tan(pi * fc / fs)
+    std::vector<float> R2;      // 1 / resonance
+    std::vector<float> h;       // 1 / (1 + R2 * g + g * g)
+    std::vector<float> cosR;    // modal engine only: r cos(theta)...
+    std::vector<float> sinR;    // ...r sin(theta)...
+    std::vector<float> drive;   // ...and input gain 2 (1 - r) q
+    std::vector<float> gain;    // curve gain * odd/even gain
+    std::vector<int> octave;    // OctaveAnalyzer octave of the centre frequency
+    std::vector<int> oversample; // rate multiple the band runs at: 1, or the oversampling factor
+    int numActive {0};
+    int engine {0};
+
+    void resize(int numHarmonics);
+
+    // the first other.numActive bands, without resizing: never allocates
+    // while this holds at least as many bands as other
+    void copyActive(const CoeffSet& other);
+};
+
+//==============================================================================
+class SharedTables
+{
+public:
+    static std::shared_ptr<const BankTables> acquireTables(int numHarmonics);
+
+    // Returns the shared set for key, or nullptr if there is none. With
+    // wait == false this only tries the lock, so it is safe on the audio thread.
+    static std::shared_ptr<const CoeffSet> findCoefficients(const CoeffKey& key, bool wait);
+
+    // Adds a copy of coeffs under key (or returns the set already there) and
+    // drops cached sets no bank is using any more. Allocates; not for the audio thread.
+    static std::shared_ptr<const CoeffSet> publishCoefficients(const CoeffKey& key, const CoeffSet& coeffs);
+
+    static int getNumCachedCoefficientSets();
+
+private:
+    static SharedTables& getInstance();
+
+    std::mutex lock;
+    std::unordered_map<int, std::weak_ptr<const BankTables>> tables;
+    std::unordered_map<CoeffKey, std::shared_ptr<const CoeffSet>, CoeffKeyHash> coefficients;
+};
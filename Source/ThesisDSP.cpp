@@ -0,0 +1,335 @@
+/*
+  ==============================================================================
+
+    ThesisDSP.cpp
+    Created: 19 Oct 2026 10:48:15am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "ThesisDSP.h"
+#include "HarmonicBank.h"
+#include "BankResponse.h"
+#include "MultiStreamBank.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+struct ThesisBank
+{
+    HarmonicBank bank;
+    BankSettings settings;
+    double sampleRate {44100.0};
+    bool prepared {false};
+
+    // changes queued for the next thesis_process, each with the settings
+    // as they stand from its offset on
+    BankEvent events[THESIS_MAX_EVENTS];
+    int numEvents {0};
+};
+
+struct ThesisStreams
+{
+    MultiStreamBank bank;
+    BankSettings settings;
+    bool prepared {false};
+};
+
+// mirrors the ranges and defaults in ThesisAudioProcessor::createParameterLayout
+static const float paramRanges[THESIS_NUM_PARAMS][3] = {
+    /* min      max         default */
+    {  0.f,     1.f,        0.5f    },  // Timbre
+    {  20.f,    10000.f,    100.f   },  // Center Frequency
+    {  1.f,     100.f,      20.f    },  // Q
+    {  0.5f,    2.f,        1.f     },  // Detune
+    {  0.f,     1.f,        1.f     },  // Stereo Link
+    {  0.f,     5.f,        1.f     },  // Quality, up to MAX_QUALITY
+    {  0.1f,    10.f,       1.f     },  // Curve
+    {  0.f,     1.f,        0.f     },  // Mod Freq
+    {  0.f,     1.f,        0.f     },  // Mod Detune
+    {  0.f,     100.f,      1.f     },  // Mod Depth
+    {  0.1f,    20.f,       1.f     },  // Mod Rate
+    {  0.f,     1.f,        0.f     },  // CPU Governor
+    {  5.f,     100.f,      25.f    },  // CPU Budget
+    {  0.f,     1.f,        0.f     },  // Mod Spread
+    {  0.f,     1.f,        0.f     },  // Mod Rate Spread
+    {  0.f,     1.f,        0.f     },  // Engine
+    {  0.f,     1.f,        0.f     },  // Band Culling
+    {  0.f,     2.f,        0.f     },  // Oversampling
+};
+
+// the plugin's parameter IDs, in ThesisParam order
+static const char* const paramIds[THESIS_NUM_PARAMS] = {
+    "Timbre", "Center Frequency", "Q", "Detune", "Stereo Link", "Quality", "Curve",
+    "Mod Freq", "Mod Detune", "Mod Depth", "Mod Rate", "CPU Governor", "CPU Budget",
+    "Mod Spread", "Mod Rate Spread", "Engine", "Band Culling", "Oversampling",
+};
+
+static void applyParam(BankSettings& settings, ThesisParam param, float value)
+{
+    value = std::min(std::max(value, paramRanges[param][0]), paramRanges[param][1]);
+
+    switch (param)
+    {
+        case THESIS_PARAM_TIMBRE:           settings.timbre = value; break;
+        case THESIS_PARAM_CENTER_FREQUENCY: settings.freq = value; break;
+        case THESIS_PARAM_Q:                settings.q = value; break;
+        case THESIS_PARAM_DETUNE:           settings.detune = value; break;
+        case THESIS_PARAM_STEREO_LINK:      settings.stereoLink = value; break;
+        case THESIS_PARAM_QUALITY:          settings.quality = int(value + 0.5f); break;
+        case THESIS_PARAM_CURVE:            settings.curve = value; break;
+        case THESIS_PARAM_MOD_FREQ:         settings.modFreq = value >= 0.5f; break;
+        case THESIS_PARAM_MOD_DETUNE:       settings.modDetune = value >= 0.5f; break;
+        case THESIS_PARAM_MOD_DEPTH:        settings.modDepth = value; break;
+        case THESIS_PARAM_MOD_RATE:         settings.modRate = value; break;
+        case THESIS_PARAM_CPU_GOVERNOR:     settings.governor = value >= 0.5f; break;
+        case THESIS_PARAM_CPU_BUDGET:       settings.cpuBudget = value; break;
+        case THESIS_PARAM_MOD_SPREAD:       settings.modSpread = value; break;
+        case THESIS_PARAM_MOD_RATE_SPREAD:  settings.modRateSpread = value; break;
+        case THESIS_PARAM_ENGINE:           settings.engine = int(value + 0.5f); break;
+        case THESIS_PARAM_CULLING:          settings.culling = value >= 0.5f; break;
+        case THESIS_PARAM_OVERSAMPLING:     settings.oversampling = int(value + 0.5f); break;
+        default: break;
+    }
+}
+
+//==============================================================================
+ThesisBank *thesis_create(void)
+{
+    ThesisBank *bank = new (std::nothrow) ThesisBank();
+
+    if (bank == nullptr)
+        return nullptr;
+
+    for (int i = 0; i < THESIS_NUM_PARAMS; i++)
+        applyParam(bank->settings, ThesisParam(i), paramRanges[i][2]);
+
+    return bank;
+}
+
+int thesis_prepare(ThesisBank *bank, double sampleRate, int maxBlockSize, int numChannels)
+{
+    if (bank == nullptr || sampleRate <= 0 || maxBlockSize <= 0 || numChannels <= 0)
+        return -1;
+
+    bank->bank.setSettings(bank->settings);
+    bank->bank.prepare(sampleRate, maxBlockSize, numChannels);
+    bank->sampleRate = sampleRate;
+    bank->prepared = true;
+
+    return 0;
+}
+
+void thesis_process(ThesisBank *bank, float **channels, int numChannels, int numSamples)
+{
+    if (bank == nullptr || ! bank->prepared)
+        return;
+
+    bank->bank.setSettings(bank->settings);
+    bank->bank.process(channels, numChannels, numSamples, bank->events, bank->numEvents);
+
+    if (bank->numEvents > 0)
+        bank->settings = bank->events[bank->numEvents - 1].settings;
+
+    bank->numEvents = 0;
+}
+
+int thesis_set_param(ThesisBank *bank, ThesisParam param, float value)
+{
+    if (bank == nullptr || param < 0 || param >= THESIS_NUM_PARAMS)
+        return -1;
+
+    applyParam(bank->settings, param, value);
+
+    if (param == THESIS_PARAM_QUALITY)
+        bank->bank.reserve(bank->settings.quality);
+
+    // from the start of the next block, so under any queued changes too
+    for (int i = 0; i < bank->numEvents; i++)
+        applyParam(bank->events[i].settings, param, value);
+
+    return 0;
+}
+
+int thesis_find_param(const char *id)
+{
+    if (id == nullptr)
+        return -1;
+
+    for (int i = 0; i < THESIS_NUM_PARAMS; i++)
+        if (std::strcmp(id, paramIds[i]) == 0)
+            return i;
+
+    return -1;
+}
+
+int thesis_set_param_at(ThesisBank *bank, ThesisParam param, float value, int sampleOffset)
+{
+    if (bank == nullptr || param < 0 || param >= THESIS_NUM_PARAMS)
+        return -1;
+
+    sampleOffset = std::max(sampleOffset, 0);
+
+    BankEvent* last = bank->numEvents > 0 ? &bank->events[bank->numEvents - 1] : nullptr;
+
+    if (last != nullptr && sampleOffset < last->sampleOffset)
+        return -1;
+
+    // several parameters at one offset are one split
+    if (last == nullptr || sampleOffset > last->sampleOffset)
+    {
+        if (bank->numEvents == THESIS_MAX_EVENTS)
+            return -1;
+
+        BankEvent& event = bank->events[bank->numEvents++];
+        event.sampleOffset = sampleOffset;
+        event.settings = last != nullptr ? last->settings : bank->settings;
+        last = &event;
+    }
+
+    applyParam(last->settings, param, value);
+
+    if (param == THESIS_PARAM_QUALITY)
+        bank->bank.reserve(last->settings.quality);
+
+    return 0;
+}
+
+int thesis_get_latency(ThesisBank *bank)
+{
+    if (bank == nullptr)
+        return 0;
+
+    return HarmonicBank::getOversamplingLatency(bank->settings.oversampling);
+}
+
+void thesis_set_offline(ThesisBank *bank, int offline)
+{
+    if (bank != nullptr)
+        bank->bank.setOffline(offline != 0);
+}
+
+void thesis_set_offline_threads(ThesisBank *bank, int numThreads)
+{
+    if (bank != nullptr)
+        bank->bank.setOfflineThreads(numThreads);
+}
+
+int thesis_set_partial_map(ThesisBank *bank, const char *path)
+{
+    if (bank == nullptr)
+        return -1;
+
+    if (path == nullptr)
+    {
+        bank->bank.setPartialMap(nullptr);
+        return 0;
+    }
+
+    auto map = PartialMap::load(path);
+
+    if (map == nullptr)
+        return -1;
+
+    bank->bank.setPartialMap(std::move(map));
+
+    return 0;
+}
+
+int thesis_get_response(ThesisBank *bank, const float *freqs, int numFreqs, float *magnitude, float *phase)
+{
+    if (bank == nullptr || ! bank->prepared || freqs == nullptr || magnitude == nullptr)
+        return -1;
+
+    computeResponse(makeResponseSnapshot(bank->settings, bank->sampleRate, bank->bank.getPartialMap()), freqs, numFreqs, magnitude, phase);
+
+    return 0;
+}
+
+int thesis_get_band_meters(ThesisBank *bank, float *rms, float *peak, int maxBands)
+{
+    if (bank == nullptr || ! bank->prepared)
+        return -1;
+
+    return bank->bank.readBandMeters(rms, peak, maxBands);
+}
+
+void thesis_destroy(ThesisBank *bank)
+{
+    delete bank;
+}
+
+//==============================================================================
+ThesisStreams *thesis_streams_create(void)
+{
+    ThesisStreams *streams = new (std::nothrow) ThesisStreams();
+
+    if (streams == nullptr)
+        return nullptr;
+
+    for (int i = 0; i < THESIS_NUM_PARAMS; i++)
+        applyParam(streams->settings, ThesisParam(i), paramRanges[i][2]);
+
+    return streams;
+}
+
+int thesis_streams_prepare(ThesisStreams *streams, double sampleRate, int maxBlockSize,
+                           int numStreams, int numChannels, int numThreads)
+{
+    if (streams == nullptr || sampleRate <= 0 || maxBlockSize <= 0 || numStreams <= 0
+        || numChannels <= 0 || numChannels > MAX_CHANNELS)
+        return -1;
+
+    streams->bank.setSettings(streams->settings);
+    streams->bank.prepare(sampleRate, maxBlockSize, numStreams, numChannels, std::max(numThreads, 1));
+    streams->prepared = true;
+
+    return 0;
+}
+
+void thesis_streams_process(ThesisStreams *streams, float **channels, int numSamples)
+{
+    if (streams == nullptr || ! streams->prepared)
+        return;
+
+    streams->bank.process(channels, numSamples);
+}
+
+int thesis_streams_set_param(ThesisStreams *streams, ThesisParam param, float value)
+{
+    if (streams == nullptr || param < 0 || param >= THESIS_NUM_PARAMS)
+        return -1;
+
+    applyParam(streams->settings, param, value);
+    streams->bank.setSettings(streams->settings);
+
+    return 0;
+}
+
+int thesis_streams_set_partial_map(ThesisStreams *streams, const char *path)
+{
+    if (streams == nullptr)
+        return -1;
+
+    if (path == nullptr)
+    {
+        streams->bank.setPartialMap(nullptr);
+        return 0;
+    }
+
+    auto map = PartialMap::load(path);
+
+    if (map == nullptr)
+        return -1;
+
+    streams->bank.setPartialMap(std::move(map));
+
+    return 0;
+}
+
+void thesis_streams_destroy(ThesisStreams *streams)
+{
+    delete streams;
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    ThesisDSP.h
+    Created: 19 Oct 2026 10:48:15am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/*
+    Plain C interface to the harmonic bank, for hosts that do not link JUCE.
+    Parameters take the same real-world values as the plugin parameters of
+    the same name and are clamped to the same ranges.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define THESIS_MAX_EVENTS   256     /* thesis_set_param_at calls per thesis_process */
+
+typedef struct ThesisBank ThesisBank;
+
+typedef enum {
+    THESIS_PARAM_TIMBRE,
+    THESIS_PARAM_CENTER_FREQUENCY,
+    THESIS_PARAM_Q,
+    THESIS_PARAM_DETUNE,
+    THESIS_PARAM_STEREO_LINK,
+    THESIS_PARAM_QUALITY,           /* 50 << quality harmonics, 0 to 5; raising it past what
+                                       thesis_prepare made room for allocates */
+    THESIS_PARAM_CURVE,
+    THESIS_PARAM_MOD_FREQ,
+    THESIS_PARAM_MOD_DETUNE,
+    THESIS_PARAM_MOD_DEPTH,
+    THESIS_PARAM_MOD_RATE,
+    THESIS_PARAM_CPU_GOVERNOR,
+    THESIS_PARAM_CPU_BUDGET,
+    THESIS_PARAM_MOD_SPREAD,
+    THESIS_PARAM_MOD_RATE_SPREAD,
+    THESIS_PARAM_ENGINE,            /* 0 = SVF, 1 = modal */
+    THESIS_PARAM_CULLING,
+    THESIS_PARAM_OVERSAMPLING,      /* top octave at 0 = 1x, 1 = 2x, 2 = 4x */
+    THESIS_NUM_PARAMS
+} ThesisParam;
+
+/* returns NULL on allocation failure */
+ThesisBank *thesis_create(void);
+
+/* returns 0 on success; must be called before thesis_process. Calling it
+   again rebuilds only what the new rate, block size or channel count
+   invalidates */
+int thesis_prepare(ThesisBank *bank, double sampleRate, int maxBlockSize, int numChannels);
+
+/* filters numChannels buffers of numSamples in place */
+void thesis_process(ThesisBank *bank, float **channels, int numChannels, int numSamples);
+
+/* returns 0 on success, -1 for an unknown parameter */
+int thesis_set_param(ThesisBank *bank, ThesisParam param, float value);
+
+/* the parameter whose plugin parameter ID is id ("Center Frequency",
+   "Band Culling", ...), or -1 if there is none */
+int thesis_find_param(const char *id);
+
+/* sample-accurate automation: the change takes effect sampleOffset samples
+   into the next thesis_process call, which splits the block there. Calls
+   between two thesis_process calls must come in order of sampleOffset.
+   Returns 0 on success, -1 for an unknown parameter, an offset out of order
+   or more than THESIS_MAX_EVENTS changes */
+int thesis_set_param_at(ThesisBank *bank, ThesisParam param, float value, int sampleOffset);
+
+/* samples the output trails the input by at the current parameters */
+int thesis_get_latency(ThesisBank *bank);
+
+/* nonzero switches to the offline profile for renders with no deadline:
+   finer modulation, double precision, 4x oversampling and every core (see
+   HarmonicBank::setOffline); the latency stays the same. Call between
+   thesis_process calls, ideally before thesis_prepare */
+void thesis_set_offline(ThesisBank *bank, int offline);
+
+/* caps the offline profile at numThreads threads, counting the caller; 0,
+   the default, uses every core. For callers that already run a bank per
+   core. Call before thesis_set_offline and thesis_prepare */
+void thesis_set_offline_threads(ThesisBank *bank, int numThreads);
+
+/* runs the partials in the map file at path (see PartialMap.h for the
+   layout) in place of the harmonic series, or the harmonics again if path
+   is NULL. Banks loading the same file share one read-only mapping. Call
+   between thesis_process calls; returns 0 on success, -1 if the file is not
+   a valid map, which leaves the current partials running */
+int thesis_set_partial_map(ThesisBank *bank, const char *path);
+
+/* linear magnitude (and phase in radians, if phase is not NULL) of the bank at
+   numFreqs frequencies in Hz, with modulation at rest; returns 0 on success.
+   Must not run concurrently with thesis_set_param on the same bank */
+int thesis_get_response(ThesisBank *bank, const float *freqs, int numFreqs, float *magnitude, float *phase);
+
+/* the RMS and peak of each band's output over the last thesis_process call,
+   fundamental first, into up to maxBands entries of rms and peak (either
+   may be NULL); returns how many bands were running, or -1. Safe from any
+   thread. Reads zero when built with THESIS_BAND_METERS=0 */
+int thesis_get_band_meters(ThesisBank *bank, float *rms, float *peak, int maxBands);
+
+void thesis_destroy(ThesisBank *bank);
+
+/* Many independent signals through one set of bands at once, for dataset
+   and stem jobs (see MultiStreamBank.h): faster than a bank per signal from
+   a dozen or so streams up. Every stream shares the parameters; the
+   modulation sits at rest, every band runs (the CPU governor and culling
+   are ignored) and there is no oversampling, so no latency. */
+typedef struct ThesisStreams ThesisStreams;
+
+/* returns NULL on allocation failure */
+ThesisStreams *thesis_streams_create(void);
+
+/* numStreams signals of numChannels (1 or 2) each, spread over numThreads
+   threads (for renders with no deadline); returns 0 on success. Must be
+   called before thesis_streams_process, and clears every stream's state */
+int thesis_streams_prepare(ThesisStreams *streams, double sampleRate, int maxBlockSize,
+                           int numStreams, int numChannels, int numThreads);
+
+/* filters channels[stream * numChannels + channel], numSamples each, in place */
+void thesis_streams_process(ThesisStreams *streams, float **channels, int numSamples);
+
+/* as thesis_set_param and thesis_set_partial_map, for every stream from the
+   next thesis_streams_process call on */
+int thesis_streams_set_param(ThesisStreams *streams, ThesisParam param, float value);
+int thesis_streams_set_partial_map(ThesisStreams *streams, const char *path);
+
+void thesis_streams_destroy(ThesisStreams *streams);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    WorkerPool.cpp
+    Created: 22 Oct 2026 10:14:37am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool() {}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+void WorkerPool::start(int numHelpers)
+{
+    stop();
+
+    quit = false;
+
+    for (int i = 0; i < numHelpers; i++)
+        helpers.emplace_back([this] { helperLoop(); });
+}
+
+void WorkerPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+
+    wake.notify_all();
+
+    for (auto& helper : helpers)
+        helper.join();
+
+    helpers.clear();
+}
+
+void WorkerPool::run(Job newJob, void* newContext, int newNumJobs)
+{
+    if (newNumJobs <= 0)
+        return;
+
+    {
+        // no helper is still inside the previous run, see below
+        std::lock_guard<std::mutex> guard(lock);
+
+        job = newJob;
+        context = newContext;
+        numJobs = newNumJobs;
+        remaining = newNumJobs;
+        nextJob = 0;
+        generation++;
+    }
+
+    wake.notify_all();
+
+    runJobs();
+
+    // every job done, and every helper out of runJobs, so the next run can
+    // reset the counters without a late helper claiming one of its jobs
+    std::unique_lock<std::mutex> guard(lock);
+    finished.wait(guard, [this] { return remaining == 0 && busyHelpers == 0; });
+}
+
+void WorkerPool::runJobs()
+{
+    for (;;)
+    {
+        int index = nextJob.fetch_add(1);
+
+        if (index >= numJobs)
+            break;
+
+        job(context, index);
+
+        if (remaining.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            finished.notify_all();
+        }
+    }
+}
+
+void WorkerPool::helperLoop()
+{
+    int seen = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return quit || generation != seen; });
+
+            if (quit)
+                return;
+
+            seen = generation;
+            busyHelpers++;
+        }
+
+        runJobs();
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            busyHelpers--;
+        }
+
+        finished.notify_all();
+    }
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+    Created: 22 Oct 2026 10:14:37am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    A few helper threads that split a loop with the calling thread, for the
+    bank's offline profile. Handing out work takes a lock and wakes the
+    helpers through a condition variable, so this is for renders without a
+    deadline only, never for the realtime path.
+*/
+
+class WorkerPool
+{
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    // numHelpers threads besides the caller; 0 runs everything on the caller
+    void start(int numHelpers);
+    void stop();
+
+    // threads run() spreads over, the caller included
+    int getNumThreads() const { return int(helpers.size()) + 1; }
+
+    typedef void (*Job)(void* context, int index);
+
+    // job(context, i) for every i in [0, numJobs), in no particular order;
+    // returns once all of them have finished
+    void run(Job job, void* context, int numJobs);
+
+private:
+    void helperLoop();
+    void runJobs();
+
+    std::vector<std::thread> helpers;
+    std::mutex lock;
+    std::condition_variable wake, finished;
+
+    Job job {nullptr};
+    void* context {nullptr};
+    int numJobs {0};
+    std::atomic<int> nextJob {0};
+    std::atomic<int> remaining {0};
+
+    int generation {0};
+    int busyHelpers {0};
+    bool quit {false};
+};
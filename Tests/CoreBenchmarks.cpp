@@ -0,0 +1,356 @@
+/*
+  ==============================================================================
+
+    CoreBenchmarks.cpp
+    Created: 19 Oct 2026 3:02:17pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "CoreBenchmarks.h"
+#include "../Source/HarmonicBank.h"
+#include "../Source/BankResponse.h"
+#include "../Source/MultiStreamBank.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+static const double pi = 3.141592653589793238463;
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void fillNoise(std::vector<float>& buffer, unsigned seed)
+{
+    std::minstd_rand random(seed);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+
+    for (auto& v : buffer)
+        v = dist(random);
+}
+
+static BankSettings makeBenchmarkSettings(int quality)
+{
+    BankSettings settings;
+
+    // a low fundamental keeps every harmonic below nyquist
+    settings.timbre = 0.5f;
+    settings.freq = 20.f;
+    settings.q = 20.f;
+    settings.stereoLink = 1.f;
+    settings.quality = quality;
+    settings.curve = 1.f;
+    settings.detune = 1.f;
+    settings.modRate = 1.f;
+    settings.modDepth = 1.f;
+    settings.cpuBudget = 25.f;
+
+    return settings;
+}
+
+//==============================================================================
+// The band-major loop from before the kernels: one band at a time over the
+// whole block, each sample waiting on the last through s1/s2.
+static double timeGenericLoop(int numBands, int numChannels, double sampleRate, int blockSize, int numBlocks)
+{
+    std::vector<float> g(numBands), R2(numBands), h(numBands), gain(numBands);
+    std::vector<float> s1(numBands * numChannels, 0.f), s2(numBands * numChannels, 0.f);
+    std::vector<float> input(blockSize * numChannels), dry(input.size()), output(input.size());
+
+    for (int i = 0; i < numBands; i++)
+    {
+        float q = 20.f * (float(i) / 2.f + 1);
+
+        g[i] = float(std::tan(pi * 20.0 * (i + 1) / sampleRate));
+        R2[i] = 1.f / q;
+        h[i] = 1.f / (1.f + R2[i] * g[i] + g[i] * g[i]);
+        gain[i] = std::pow(1.f / q, 0.8f);
+    }
+
+    fillNoise(input, 1);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        std::memcpy(dry.data(), input.data(), sizeof(float) * input.size());
+        std::memset(output.data(), 0, sizeof(float) * output.size());
+
+        for (int harm = 0; harm < numBands; harm++)
+        {
+            for (int chan = 0; chan < numChannels; chan++)
+            {
+                const float* in = &dry[chan * blockSize];
+                float* out = &output[chan * blockSize];
+                float ls1 = s1[harm * numChannels + chan];
+                float ls2 = s2[harm * numChannels + chan];
+
+                for (int n = 0; n < blockSize; n++)
+                {
+                    float yHP = h[harm] * (in[n] - ls1 * (g[harm] + R2[harm]) - ls2);
+
+                    float yBP = yHP * g[harm] + ls1;
+                    ls1 = yHP * g[harm] + yBP;
+
+                    float yLP = yBP * g[harm] + ls2;
+                    ls2 = yBP * g[harm] + yLP;
+
+                    out[n] += yBP * gain[harm];
+                }
+
+                s1[harm * numChannels + chan] = ls1;
+                s2[harm * numChannels + chan] = ls2;
+            }
+        }
+    }
+
+    return secondsSince(start);
+}
+
+static double timeBank(int quality, int engine, int numChannels, double sampleRate, int blockSize, int numBlocks)
+{
+    HarmonicBank bank;
+    std::vector<float> input(blockSize * numChannels), buffer(input.size());
+    float* channels[MAX_CHANNELS];
+
+    BankSettings settings = makeBenchmarkSettings(quality);
+    settings.engine = engine;
+
+    bank.setSettings(settings);
+    bank.prepare(sampleRate, blockSize, numChannels);
+
+    fillNoise(input, 1);
+
+    for (int chan = 0; chan < numChannels; chan++)
+        channels[chan] = &buffer[chan * blockSize];
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        std::memcpy(buffer.data(), input.data(), sizeof(float) * input.size());
+        bank.process(channels, numChannels, blockSize);
+    }
+
+    return secondsSince(start);
+}
+
+std::vector<KernelBenchmark> benchmarkKernels(double sampleRate, int blockSize, int numBlocks)
+{
+    std::vector<KernelBenchmark> results;
+
+    for (int quality = 0; quality <= 2; quality++)
+    {
+        for (int numChannels = 1; numChannels <= MAX_CHANNELS; numChannels++)
+        {
+            KernelBenchmark result;
+            result.numBands = 50 << quality;
+            result.numChannels = numChannels;
+
+            double bandSamples = double(result.numBands) * numChannels * blockSize * numBlocks;
+
+            result.genericNs = timeGenericLoop(result.numBands, numChannels, sampleRate, blockSize, numBlocks) * 1.0e9 / bandSamples;
+            result.kernelNs = timeBank(quality, ENGINE_SVF, numChannels, sampleRate, blockSize, numBlocks) * 1.0e9 / bandSamples;
+            result.modalNs = timeBank(quality, ENGINE_MODAL, numChannels, sampleRate, blockSize, numBlocks) * 1.0e9 / bandSamples;
+
+            results.push_back(result);
+        }
+    }
+
+    return results;
+}
+
+double benchmarkResponse(int numFreqs, int numCalls, double sampleRate)
+{
+    auto snapshot = makeResponseSnapshot(makeBenchmarkSettings(2), sampleRate);
+
+    // log-spaced from 20 Hz up to nyquist
+    std::vector<float> freqs(numFreqs), magnitude(numFreqs), phase(numFreqs);
+    for (int i = 0; i < numFreqs; i++)
+        freqs[i] = float(20.0 * std::pow(sampleRate / 40.0, double(i) / std::max(1, numFreqs - 1)));
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int call = 0; call < numCalls; call++)
+        computeResponse(snapshot, freqs.data(), numFreqs, magnitude.data(), phase.data());
+
+    return secondsSince(start) * 1.0e6 / numCalls;
+}
+
+//==============================================================================
+static void fillBassLine(std::vector<float>& buffer, double sampleRate, bool sparse)
+{
+    const double notes[] = { 55.0, 73.42, 82.41, 110.0, 98.0, 65.41, 0.0, 55.0 };    // 0 = rest
+    const int numNotes = int(sizeof(notes) / sizeof(notes[0]));
+    const int noteLength = int(0.25 * sampleRate);
+
+    // 10 ms attacks, so the notes themselves do not click
+
+    double phase = 0;
+
+    for (size_t i = 0; i < buffer.size(); i++)
+    {
+        int note = int(i / size_t(noteLength)) % numNotes;
+        double t = double(i % size_t(noteLength)) / sampleRate;
+        double envelope = std::min(1.0, t / 0.01) * std::exp(-6.0 * t);
+
+        // sparse: the first bar of the line, then three bars of rest
+        bool resting = sparse && int(i / size_t(noteLength * numNotes)) % 4 != 0;
+
+        if (notes[note] == 0.0 || resting)
+        {
+            buffer[i] = 0;
+            continue;
+        }
+
+        phase += 2.0 * pi * notes[note] / sampleRate;
+
+        buffer[i] = float(0.5 * envelope * (std::sin(phase) + 0.3 * std::sin(2.0 * phase) + 0.1 * std::sin(3.0 * phase)));
+    }
+}
+
+static double timeCulling(bool culling, const std::vector<float>& input, double sampleRate, int blockSize,
+                          int& numActive, double& averageCulled)
+{
+    HarmonicBank bank;
+    std::vector<float> buffer(input);
+
+    BankSettings settings = makeBenchmarkSettings(2);
+    settings.freq = 100.f;
+    settings.culling = culling;
+
+    bank.setSettings(settings);
+    bank.prepare(sampleRate, blockSize, 1);
+
+    int numBlocks = int(buffer.size()) / blockSize;
+    double culledSum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        float* channels[1] = { &buffer[size_t(block * blockSize)] };
+        bank.process(channels, 1, blockSize);
+        culledSum += bank.getNumCulledBands();
+    }
+
+    double seconds = secondsSince(start);
+
+    numActive = bank.getNumActiveHarmonics();
+    averageCulled = culledSum / std::max(1, numBlocks);
+
+    return seconds * 1.0e6 / std::max(1, numBlocks);
+}
+
+CullingBenchmark benchmarkCulling(double sampleRate, int blockSize, double seconds)
+{
+    CullingBenchmark result;
+    std::vector<float> input(size_t(seconds * sampleRate)), sparse(input.size());
+    double unused = 0;
+
+    fillBassLine(input, sampleRate, false);
+    fillBassLine(sparse, sampleRate, true);
+
+    result.plainMicros = timeCulling(false, input, sampleRate, blockSize, result.numActive, unused);
+    result.culledMicros = timeCulling(true, input, sampleRate, blockSize, result.numActive, result.averageCulled);
+
+    result.sparsePlainMicros = timeCulling(false, sparse, sampleRate, blockSize, result.numActive, unused);
+    result.sparseCulledMicros = timeCulling(true, sparse, sampleRate, blockSize, result.numActive,
+                                            result.sparseAverageCulled);
+
+    return result;
+}
+
+//==============================================================================
+static double timeSeparateStreams(int numStreams, int engine, double sampleRate, int blockSize, int numBlocks)
+{
+    std::vector<HarmonicBank> banks(static_cast<size_t>(numStreams));
+    std::vector<float> input(size_t(blockSize * MAX_CHANNELS * numStreams)), buffer(input.size());
+
+    BankSettings settings = makeBenchmarkSettings(1);
+    settings.engine = engine;
+
+    for (auto& bank : banks)
+    {
+        bank.setSettings(settings);
+        bank.prepare(sampleRate, blockSize, MAX_CHANNELS);
+    }
+
+    fillNoise(input, 1);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        std::memcpy(buffer.data(), input.data(), sizeof(float) * input.size());
+
+        for (int stream = 0; stream < numStreams; stream++)
+        {
+            float* channels[MAX_CHANNELS];
+
+            for (int chan = 0; chan < MAX_CHANNELS; chan++)
+                channels[chan] = &buffer[size_t((stream * MAX_CHANNELS + chan) * blockSize)];
+
+            banks[size_t(stream)].process(channels, MAX_CHANNELS, blockSize);
+        }
+    }
+
+    return secondsSince(start);
+}
+
+static double timeMultiStream(int numStreams, int engine, double sampleRate, int blockSize, int numBlocks)
+{
+    MultiStreamBank bank;
+    std::vector<float> input(size_t(blockSize * MAX_CHANNELS * numStreams)), buffer(input.size());
+    std::vector<float*> channels(size_t(MAX_CHANNELS * numStreams));
+
+    BankSettings settings = makeBenchmarkSettings(1);
+    settings.engine = engine;
+
+    bank.setSettings(settings);
+    bank.prepare(sampleRate, blockSize, numStreams, MAX_CHANNELS);
+
+    fillNoise(input, 1);
+
+    for (size_t i = 0; i < channels.size(); i++)
+        channels[i] = &buffer[i * size_t(blockSize)];
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        std::memcpy(buffer.data(), input.data(), sizeof(float) * input.size());
+        bank.process(channels.data(), blockSize);
+    }
+
+    return secondsSince(start);
+}
+
+std::vector<StreamBenchmark> benchmarkStreams(double sampleRate, int blockSize, int streamBlocks)
+{
+    std::vector<StreamBenchmark> results;
+
+    for (int numStreams : { 1, 8, 64, 256 })
+    {
+        StreamBenchmark result;
+        result.numStreams = numStreams;
+
+        const int numBlocks = std::max(1, streamBlocks / numStreams);
+        const int numBands = HarmonicBank::getNumHarmonics(1);
+        double bandSamples = double(numBands) * MAX_CHANNELS * numStreams * blockSize * numBlocks;
+
+        result.separateNs = timeSeparateStreams(numStreams, ENGINE_SVF, sampleRate, blockSize, numBlocks) * 1.0e9 / bandSamples;
+        result.multiNs = timeMultiStream(numStreams, ENGINE_SVF, sampleRate, blockSize, numBlocks) * 1.0e9 / bandSamples;
+        result.modalNs = timeMultiStream(numStreams, ENGINE_MODAL, sampleRate, blockSize, numBlocks) * 1.0e9 / bandSamples;
+
+        results.push_back(result);
+    }
+
+    return results;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    CoreBenchmarks.h
+    Created: 19 Oct 2026 3:02:17pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+/*
+    Micro-benchmarks for the DSP core. They only need the standard library,
+    so they can be run from any small driver without JUCE. Times are in
+    nanoseconds per band per sample (one band on one channel for one sample).
+*/
+
+struct KernelBenchmark
+{
+    int numBands {0};
+    int numChannels {0};
+    double genericNs {0};       // band-major loop the bank used before the kernels
+    double kernelNs {0};        // HarmonicBank with the specialised kernels
+    double modalNs {0};         // the same with the modal resonator engine
+};
+
+std::vector<KernelBenchmark> benchmarkKernels(double sampleRate = 48000.0, int blockSize = 512, int numBlocks = 1000);
+
+struct CullingBenchmark
+{
+    int numActive {0};
+    double plainMicros {0};     // per block with every band running...
+    double culledMicros {0};    // ...and with band culling
+    double averageCulled {0};   // bands culled per block
+
+    // the same for the sparse bass line
+    double sparsePlainMicros {0};
+    double sparseCulledMicros {0};
+    double sparseAverageCulled {0};
+};
+
+// A synthetic bass line (plucked notes between 55 and 110 Hz with a few
+// partials and gaps) through a bank tuned to 100 Hz with harmonics up to
+// 20 kHz, with and without input-energy band culling. The dense line plays
+// throughout; the sparse one plays a bar in every four and rests in between,
+// which is where culling saves.
+CullingBenchmark benchmarkCulling(double sampleRate = 48000.0, int blockSize = 512, double seconds = 10.0);
+
+// microseconds per computeResponse call over all 200 bands (see BankResponse.h)
+double benchmarkResponse(int numFreqs = 1024, int numCalls = 100, double sampleRate = 48000.0);
+
+struct StreamBenchmark
+{
+    int numStreams {0};
+    double separateNs {0};      // one HarmonicBank per stream...
+    double multiNs {0};         // ...and one MultiStreamBank for all of them
+    double modalNs {0};         // the same with the modal resonator engine
+};
+
+// Stereo streams of noise through 100 bands, numStreams at a time, in
+// nanoseconds per band per channel-sample. Each measurement runs about
+// streamBlocks blocks of one stream, however many streams that is spread over.
+std::vector<StreamBenchmark> benchmarkStreams(double sampleRate = 48000.0, int blockSize = 512, int streamBlocks = 4000);
@@ -0,0 +1,458 @@
+/*
+  ==============================================================================
+
+    CoreTests.cpp
+    Created: 27 Oct 2026 9:41:05am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Source/HarmonicBank.h"
+#include "../Source/ModBank.h"
+#include "../Source/MultiStreamBank.h"
+#include "../Source/RealtimeCheck.h"
+#include "../Source/ThesisDSP.h"
+
+#if defined(__linux__)
+ #include <fcntl.h>
+ #include <malloc.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+/*
+    Tests of the JUCE-free core, linked against ThesisCore alone, so they
+    build and run anywhere CMake and a C++17 compiler do. The realtime
+    checker is linked in and on (THESIS_RT_CHECK=1), as in ThesisTests:
+
+        cmake -S . -B build && cmake --build build && ctest --test-dir build
+
+    It exits with 1 if any of them fails.
+*/
+
+#define TEST_RATE       48000.0
+#define TEST_BLOCK      256
+
+static bool report(const std::string& name, bool passed, const std::string& detail = {})
+{
+    std::cout << (passed ? "PASS " : "FAIL ") << name;
+
+    if (! detail.empty())
+        std::cout << ": " << detail;
+
+    std::cout << std::endl;
+
+    return passed;
+}
+
+static std::vector<std::vector<float>> makeNoise(int numChannels, int numSamples)
+{
+    std::mt19937 random(0xc0de);
+    std::uniform_real_distribution<float> uniform(-0.5f, 0.5f);
+    std::vector<std::vector<float>> audio(size_t(numChannels), std::vector<float>(size_t(numSamples), 0.f));
+
+    for (auto& channel : audio)
+        for (auto& sample : channel)
+            sample = uniform(random);
+
+    return audio;
+}
+
+static std::vector<float*> pointersTo(std::vector<std::vector<float>>& audio)
+{
+    std::vector<float*> channels;
+
+    for (auto& channel : audio)
+        channels.push_back(channel.data());
+
+    return channels;
+}
+
+static BankSettings makeSettings()
+{
+    BankSettings settings;
+    settings.freq = 110.f;
+    settings.q = 40.f;
+    settings.curve = 1.f;
+    settings.detune = 0.f;
+    settings.timbre = 0.f;
+    settings.quality = 1;
+
+    return settings;
+}
+
+//==============================================================================
+// process before prepare has no block size to cut the input into, and
+// must hand the audio back as it came rather than loop forever
+static bool testProcessBeforePrepare()
+{
+    auto audio = makeNoise(2, TEST_BLOCK);
+    const auto input = audio;
+    auto channels = pointersTo(audio);
+
+    HarmonicBank bank;
+    bank.setSettings(makeSettings());
+    bank.process(channels.data(), 2, TEST_BLOCK);
+
+    BankEvent event;
+    event.sampleOffset = TEST_BLOCK / 2;
+    event.settings = makeSettings();
+    event.settings.freq = 220.f;
+    bank.process(channels.data(), 2, TEST_BLOCK, &event, 1);
+
+    bool passed = audio == input && bank.getSettings().freq == 220.f;
+
+    MultiStreamBank streams;
+    streams.setSettings(makeSettings());
+    streams.process(channels.data(), TEST_BLOCK);
+
+    passed &= audio == input;
+
+    auto* api = thesis_create();
+    thesis_process(api, channels.data(), 2, TEST_BLOCK);
+    passed &= audio == input && thesis_prepare(api, TEST_RATE, 0, 2) != 0;
+    thesis_process(api, channels.data(), 2, TEST_BLOCK);
+    thesis_destroy(api);
+
+    passed &= audio == input;
+
+    return report("process before prepare", passed);
+}
+
+// the same bank once prepared does filter, and stays finite
+static bool testProcessAfterPrepare()
+{
+    auto audio = makeNoise(2, 4 * TEST_BLOCK);
+    const auto input = audio;
+    auto channels = pointersTo(audio);
+
+    HarmonicBank bank;
+    bank.setSettings(makeSettings());
+    bank.prepare(TEST_RATE, TEST_BLOCK, 2);
+    bank.process(channels.data(), 2, 4 * TEST_BLOCK);
+
+    bool finite = true;
+
+    for (const auto& channel : audio)
+        for (float sample : channel)
+            finite &= std::isfinite(sample);
+
+    return report("process after prepare", finite && audio != input);
+}
+
+// the offline profile's threads start in prepare, not on the switch
+static bool testOfflineReadyAfterPrepare()
+{
+    HarmonicBank realtime;
+    realtime.setSettings(makeSettings());
+    realtime.prepare(TEST_RATE, TEST_BLOCK, 2);
+
+    HarmonicBank offline;
+    offline.setSettings(makeSettings());
+    offline.setOfflineThreads(2);
+    offline.setOffline(true);
+    offline.prepare(TEST_RATE, TEST_BLOCK, 2);
+
+    // once up, the threads stay for the next bounce
+    offline.setOffline(false);
+
+    return report("offline ready after prepare", ! realtime.isOfflineReady() && offline.isOfflineReady());
+}
+
+// a capture keeps a map's content hash to tell whether the file at its
+// path is still that map at replay
+static bool testPartialMapHash()
+{
+    const std::string path = "CoreTestsHash.thpm";
+    std::vector<Partial> partials(32);
+
+    for (size_t i = 0; i < partials.size(); i++)
+        partials[i].ratio = float(i + 1);
+
+    auto first = PartialMap::write(path, partials) ? PartialMap::load(path) : nullptr;
+    auto copy = PartialMap::write(path + ".copy", partials) ? PartialMap::load(path + ".copy") : nullptr;
+
+    partials.back().gain = 0.5f;
+    auto changed = PartialMap::write(path, partials) ? PartialMap::load(path) : nullptr;
+
+    bool passed = first != nullptr && copy != nullptr && changed != nullptr
+                  && first->getContentHash() == copy->getContentHash()
+                  && first->getContentHash() != changed->getContentHash();
+
+    std::remove(path.c_str());
+    std::remove((path + ".copy").c_str());
+
+    return report("partial map content hash", passed);
+}
+
+// after a burst, culling takes every band down in the rest that follows
+// once it has rung out (a low Q, so that takes a few seconds)
+static bool testCullingInRests()
+{
+    auto settings = makeSettings();
+    settings.q = 4.f;
+    settings.culling = true;
+
+    HarmonicBank bank;
+    bank.setSettings(settings);
+    bank.prepare(TEST_RATE, TEST_BLOCK, 2);
+
+    auto audio = makeNoise(2, 20 * TEST_BLOCK);
+    auto channels = pointersTo(audio);
+    bank.process(channels.data(), 2, 20 * TEST_BLOCK);
+
+    int culledInBurst = bank.getNumCulledBands();
+
+    for (int n = 0; n < int(4 * TEST_RATE) / TEST_BLOCK; n++)
+    {
+        for (auto& channel : audio)
+            std::fill(channel.begin(), channel.begin() + TEST_BLOCK, 0.f);
+
+        bank.process(channels.data(), 2, TEST_BLOCK);
+    }
+
+    int culledInRest = bank.getNumCulledBands();
+    bool passed = culledInBurst < bank.getNumActiveHarmonics() && culledInRest == bank.getNumActiveHarmonics();
+
+    return report("culling in rests", passed,
+                  std::to_string(culledInBurst) + " then " + std::to_string(culledInRest) + " of "
+                  + std::to_string(bank.getNumActiveHarmonics()) + " bands culled");
+}
+
+// the LFOs land in the same place however a block is split into ticks,
+// and a change of phase spread moves them there rather than jumping
+static bool testModBankTicks()
+{
+    const int numOscillators = 400;
+    std::vector<float> whole(numOscillators), split(numOscillators), last(numOscillators);
+
+    ModBank a, b;
+    a.prepare(TEST_RATE, numOscillators);
+    b.prepare(TEST_RATE, numOscillators);
+
+    for (auto* bank : { &a, &b })
+    {
+        bank->setRate(3.f, 0.5f);
+        bank->setPhaseSpread(0.25f);
+    }
+
+    for (int n = 0; n < 500; n++)
+    {
+        a.tick(TEST_BLOCK, 1.f, whole.data());
+        b.tick(1 + n % 100, 1.f, split.data());
+        b.tick(TEST_BLOCK - 1 - n % 100, 1.f, split.data());
+    }
+
+    a.read(1.f, whole.data());
+    b.read(1.f, split.data());
+
+    float difference = 0;
+    for (int i = 0; i < numOscillators; i++)
+        difference = std::max(difference, std::abs(whole[i] - split[i]));
+
+    // the top harmonic glides a whole cycle in MODBANK_GLIDE_SECONDS, which
+    // moves it about 0.1 per 32 samples; reseeding it would step by up to 2
+    a.setPhaseSpread(1.25f);
+    a.read(1.f, last.data());
+
+    float step = 0;
+    for (int n = 0; n < int(0.2 * TEST_RATE) / 32; n++)
+    {
+        a.tick(32, 1.f, whole.data());
+        a.read(1.f, whole.data());
+
+        for (int i = 0; i < numOscillators; i++)
+            step = std::max(step, std::abs(whole[i] - last[i]));
+
+        last = whole;
+    }
+
+    // with no spread every oscillator runs exactly as a lone one would, span
+    // changes and all, which is what the golden reference's LFO relies on
+    ModBank lone, bank;
+    lone.prepare(TEST_RATE, 1);
+    bank.prepare(TEST_RATE, numOscillators);
+
+    bool exact = true;
+    float value = 0;
+
+    for (int n = 0; n < 200; n++)
+    {
+        const int running = n < 100 ? numOscillators : numOscillators / 2;
+
+        lone.setRate(1.f + float(n / 50), 0.f);
+        bank.setRate(1.f + float(n / 50), 0.f);
+        bank.setSpan(running);
+
+        lone.tick(TEST_BLOCK, 0.5f, &value);
+        bank.tick(TEST_BLOCK, 0.5f, whole.data());
+
+        for (int i = 0; i < running; i++)
+            exact &= whole[i] == value;
+    }
+
+    return report("mod bank ticks", difference < 1e-4f && step < 0.2f && exact,
+                  "split ticks " + std::to_string(difference) + " apart, steps up to " + std::to_string(step)
+                  + (exact ? "" : ", unspread oscillators differ"));
+}
+
+//==============================================================================
+// where the allocations below go, so the compiler cannot drop them
+static void* volatile keep = nullptr;
+
+// every entry point the checker intercepts reports once called inside a
+// region; each is called outside one first, so resolving it is not counted
+static bool testRealtimeCheckCatches()
+{
+   #if defined(__linux__)
+    struct alignas(64) Aligned { float values[16]; };
+
+    const char* path = "/dev/null";
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER, other = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+    timespec past {0, 0};
+    char byte = 0;
+    int fd = -1;
+
+    std::vector<std::pair<std::string, std::function<void()>>> calls =
+    {
+        { "malloc",                 [] { keep = std::malloc(16); std::free(keep); } },
+        { "aligned_alloc",          [] { keep = aligned_alloc(64, 64); std::free(keep); } },
+        { "posix_memalign",         [] { void* ptr = nullptr; if (posix_memalign(&ptr, 64, 64) == 0) std::free(ptr); } },
+        { "memalign",               [] { keep = memalign(64, 64); std::free(keep); } },
+        { "operator new",           [] { keep = new int(1); delete static_cast<int*>(keep); } },
+        { "aligned operator new",   [] { keep = new Aligned(); delete static_cast<Aligned*>(keep); } },
+        { "pthread_mutex_lock",     [&] { pthread_mutex_lock(&other); pthread_mutex_unlock(&other); } },
+        { "pthread_cond_timedwait", [&] { pthread_cond_timedwait(&cond, &mutex, &past); } },
+        { "pthread_cond_clockwait", [&] { pthread_cond_clockwait(&cond, &mutex, CLOCK_MONOTONIC, &past); } },
+        { "open",                   [&] { close(fd); fd = open(path, O_RDWR); } },
+        { "read",                   [&] { (void) read(fd, &byte, 1); } },
+        { "write",                  [&] { (void) write(fd, &byte, 1); } },
+        { "poll",                   [] { poll(nullptr, 0, 0); } },
+        { "fsync",                  [&] { fsync(fd); } },
+        { "usleep",                 [] { usleep(0); } },
+        { "nanosleep",              [&] { nanosleep(&past, nullptr); } },
+    };
+
+    // the timed waits need the mutex held, and time out at once
+    pthread_mutex_lock(&mutex);
+    fd = open(path, O_RDWR);
+
+    for (auto& call : calls)
+        call.second();
+
+    std::string missed;
+
+    for (auto& call : calls)
+    {
+        int before = getRealtimeViolationCount();
+
+        {
+            THESIS_RT_REGION;
+            call.second();
+        }
+
+        if (getRealtimeViolationCount() == before)
+            missed += (missed.empty() ? "" : ", ") + call.first;
+    }
+
+    pthread_mutex_unlock(&mutex);
+    close(fd);
+    resetRealtimeViolations();
+
+    return report("realtime check catches", missed.empty(), missed.empty() ? "" : "missed " + missed);
+   #else
+    return report("realtime check catches", true, "only interposed on Linux");
+   #endif
+}
+
+// A bank at settings away from the defaults (a partial map, Quality 2, the
+// modal engine, oversampling and modulation on) processes without a single
+// allocation, lock or syscall once prepared
+static bool testProcessUnderRealtimeCheck()
+{
+    const std::string mapPath = "CoreTests.thpm";
+    std::vector<Partial> partials;
+
+    for (int i = 1; i <= 120; i++)
+    {
+        Partial partial;
+        partial.ratio = float(i) * std::sqrt(1.f + 0.0004f * float(i * i));     // a stiff string
+        partial.gain = 1.f / float(i);
+        partials.push_back(partial);
+    }
+
+    auto map = PartialMap::write(mapPath, partials) ? PartialMap::load(mapPath) : nullptr;
+
+    if (map == nullptr)
+        return report("process under realtime check", false, "could not write " + mapPath);
+
+    auto settings = makeSettings();
+    settings.quality = 2;
+    settings.engine = ENGINE_MODAL;
+    settings.oversampling = 1;
+    settings.modFreq = true;
+    settings.modRate = 3.f;
+    settings.modDepth = 0.5f;
+    settings.modSpread = 0.5f;
+
+    HarmonicBank bank;
+    bank.setSettings(settings);
+    bank.setPartialMap(map);
+    bank.prepare(TEST_RATE, TEST_BLOCK, 2);
+
+    auto audio = makeNoise(2, TEST_BLOCK);
+    auto channels = pointersTo(audio);
+
+    resetRealtimeViolations();
+
+    for (int n = 0; n < 200; n++)
+    {
+        // the Center Frequency moves every block, as automation does
+        settings.freq = 55.f + float(n % 50) * 8.f;
+
+        THESIS_RT_REGION;
+        bank.setSettings(settings);
+        bank.process(channels.data(), 2, 1 + n % TEST_BLOCK);
+    }
+
+    int violations = getRealtimeViolationCount();
+
+    bank.setPartialMap(nullptr);
+    map.reset();
+    std::remove(mapPath.c_str());
+
+    return report("process under realtime check", violations == 0,
+                  std::to_string(violations) + " violations");
+}
+
+//==============================================================================
+int main()
+{
+    bool passed = true;
+
+    passed &= testProcessBeforePrepare();
+    passed &= testProcessAfterPrepare();
+    passed &= testOfflineReadyAfterPrepare();
+    passed &= testPartialMapHash();
+    passed &= testCullingInRests();
+    passed &= testModBankTicks();
+    passed &= testRealtimeCheckCatches();
+    passed &= testProcessUnderRealtimeCheck();
+
+    std::cout << (passed ? "all tests passed" : "tests FAILED") << std::endl;
+
+    return passed ? 0 : 1;
+}
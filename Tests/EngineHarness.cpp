@@ -0,0 +1,824 @@
+/*
+  ==============================================================================
+
+    EngineHarness.cpp
+    Created: 19 Oct 2026 9:14:22am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "EngineHarness.h"
+#include "../Source/MultiStreamBank.h"
+
+//==============================================================================
+void ReferenceEngine::prepare(double newSampleRate, int newBlockSize)
+{
+    sampleRate = newSampleRate;
+    blockSize = newBlockSize;
+
+    // sized for REFERENCE_HARM so small blocks cannot index past the end
+    modVector.assign(size_t(juce::jmax(blockSize, REFERENCE_HARM)), 0.f);
+
+    mod.initMod(int(sampleRate));
+    mod.setMod(1.f);
+
+    lfo.prepare(sampleRate, 1);
+
+    juce::dsp::ProcessSpec spec;
+    spec.maximumBlockSize = juce::uint32(blockSize);
+    spec.numChannels = 2;
+    spec.sampleRate = sampleRate;
+
+    for (int i = 0; i < REFERENCE_HARM; i++)
+    {
+        leftChain[i].prepare(spec);
+        leftChain[i].get<BPChainPositions::BPFilter>().setType(juce::dsp::StateVariableTPTFilterType::bandpass);
+        rightChain[i].prepare(spec);
+        rightChain[i].get<BPChainPositions::BPFilter>().setType(juce::dsp::StateVariableTPTFilterType::bandpass);
+    }
+}
+
+void ReferenceEngine::render(juce::AudioBuffer<float>& buffer, const ChainSettings& settings)
+{
+    updateAll(settings);
+
+    for (int start = 0; start < buffer.getNumSamples(); start += blockSize)
+    {
+        int len = juce::jmin(blockSize, buffer.getNumSamples() - start);
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, len);
+        processBlock(block, settings);
+    }
+}
+
+void ReferenceEngine::processBlock(juce::AudioBuffer<float>& buffer, const ChainSettings& chainSettings)
+{
+    int bufferSize = buffer.getNumSamples();
+    int numHarm = int(50.f * pow(2.f, float(chainSettings.quality)));
+    float freq, nyquist, modDepth;
+
+    nyquist = float(sampleRate) / 2.f;
+    modDepth = chainSettings.modDepth / 100.f;
+    bool modState = chainSettings.modDetune || chainSettings.modFreq;
+    if (legacyModulation)
+    {
+        mod.updateMod(chainSettings.modRate);
+
+        for (int i = 0; i < bufferSize; i++)
+            modVector[size_t(i)] = mod.modBlock(bufferSize)[i] * modDepth;
+    }
+    else
+    {
+        // the bank ticks its LFOs once per block, as here, and with no
+        // spread every harmonic's runs exactly as the fundamental's
+        float value = 0;
+
+        lfo.setRate(chainSettings.modRate, 0.f);
+        lfo.setPhaseSpread(0.f);
+        lfo.tick(bufferSize, modDepth, &value);
+
+        std::fill(modVector.begin(), modVector.end(), value);
+    }
+
+    updateAll(chainSettings);
+
+    juce::AudioBuffer<float> effectBuffer;
+    effectBuffer.makeCopyOf(buffer);
+
+    juce::AudioBuffer<float> tempBuffer;
+
+    for (int harm = 0; harm < numHarm; harm++)
+    {
+        tempBuffer.makeCopyOf(buffer);
+        freq = getCurFreq(chainSettings, harm);
+
+        if (freq < nyquist)
+        {
+            if (modState)
+                processWithMod(tempBuffer, chainSettings, harm);
+            else
+                processNoMod(tempBuffer, harm);
+
+            if (harm == 0)
+                for (int chan = 0; chan < buffer.getNumChannels(); chan++)
+                    effectBuffer.copyFrom(chan, 0, tempBuffer, chan, 0, bufferSize);
+            else
+                for (int chan = 0; chan < buffer.getNumChannels(); chan++)
+                    effectBuffer.addFrom(chan, 0, tempBuffer, chan, 0, bufferSize);
+        }
+        else
+            break;
+    }
+
+    buffer.makeCopyOf(effectBuffer);
+}
+
+void ReferenceEngine::processNoMod(juce::AudioBuffer<float>& buffer, int harm)
+{
+    juce::dsp::AudioBlock<float> tempBlock(buffer);
+
+    auto leftBlock = tempBlock.getSingleChannelBlock(LEFT_CHANNEL);
+    auto rightBlock = tempBlock.getSingleChannelBlock(RIGHT_CHANNEL);
+
+    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
+    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+
+    leftChain[harm].process(leftContext);
+    rightChain[harm].process(rightContext);
+}
+
+void ReferenceEngine::processWithMod(juce::AudioBuffer<float>& buffer, const ChainSettings& chainSettings, int harm)
+{
+    int bufferSize = buffer.getNumSamples();
+    float leftSamp, rightSamp;
+    bool filterCheck = true;
+
+    for (int n = 0; n < bufferSize; n++)
+    {
+        filterCheck = updateSVFilter(chainSettings, harm);
+
+        leftSamp = buffer.getSample(LEFT_CHANNEL, n);
+        rightSamp = buffer.getSample(RIGHT_CHANNEL, n);
+
+        leftSamp = leftChain[harm].get<BPChainPositions::BPFilter>().processSample(LEFT_CHANNEL, leftSamp);
+        rightSamp = rightChain[harm].get<BPChainPositions::BPFilter>().processSample(RIGHT_CHANNEL, rightSamp);
+
+        leftSamp = leftChain[harm].get<BPChainPositions::CurveGain>().processSample(leftSamp);
+        rightSamp = rightChain[harm].get<BPChainPositions::CurveGain>().processSample(rightSamp);
+
+        leftSamp = leftChain[harm].get<BPChainPositions::OddEvenGain>().processSample(leftSamp);
+        rightSamp = rightChain[harm].get<BPChainPositions::OddEvenGain>().processSample(rightSamp);
+
+        buffer.setSample(LEFT_CHANNEL, n, leftSamp);
+        buffer.setSample(RIGHT_CHANNEL, n, rightSamp);
+
+        if (!filterCheck)
+            buffer.applyGainRamp(0, n, 1.f, 0.f);
+    }
+}
+
+void ReferenceEngine::updateAll(const ChainSettings& chainSettings)
+{
+    float nyquist = float(sampleRate) / 2.f;
+
+    for (int i = 0; i < REFERENCE_HARM; i++)
+    {
+        if (getCurFreq(chainSettings, i) < nyquist)
+        {
+            updateSVFilter(chainSettings, i);
+            updateCurveGain(chainSettings, i);
+            updateOddEvenGain(chainSettings, i);
+        }
+        else
+            break;
+    }
+}
+
+bool ReferenceEngine::updateSVFilter(const ChainSettings& chainSettings, int i)
+{
+    float freq, q, nyquist;
+
+    freq = getCurFreq(chainSettings, i);
+    q = chainSettings.q * (float(i) / 2.f + 1);
+
+    freq = wrap(freq, int(sampleRate));
+
+    nyquist = float(sampleRate) / 2.f;
+
+    if (freq < 20.f || freq >= nyquist)
+        return false;
+
+    leftChain[i].get<BPChainPositions::BPFilter>().setCutoffFrequency(freq);
+    leftChain[i].get<BPChainPositions::BPFilter>().setResonance(q);
+
+    rightChain[i].get<BPChainPositions::BPFilter>().setCutoffFrequency(freq);
+    rightChain[i].get<BPChainPositions::BPFilter>().setResonance(q);
+
+    return true;
+}
+
+void ReferenceEngine::updateCurveGain(const ChainSettings& chainSettings, int i)
+{
+    float gain, normGain, q;
+
+    q = chainSettings.q * (float(i) / 2.f + 1);
+
+    normGain = pow((1.f/q), 0.8);
+
+    gain = pow((-1.f / float(REFERENCE_HARM)) * float(i) + 1.f, (1.f / chainSettings.curve));
+
+    gain *= normGain;
+
+    leftChain[i].get<BPChainPositions::CurveGain>().setGainLinear(gain);
+    rightChain[i].get<BPChainPositions::CurveGain>().setGainLinear(gain);
+}
+
+void ReferenceEngine::updateOddEvenGain(const ChainSettings& chainSettings, int i)
+{
+    float timbre, oddGain, evenGain;
+
+    timbre = chainSettings.timbre;
+    oddGain = timbre * -1.f + 1.f;
+    evenGain = timbre;
+
+    float gain = i == 0 ? 1.f : (i % 2 == 1 ? oddGain : evenGain);
+
+    leftChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(gain);
+    rightChain[i].get<BPChainPositions::OddEvenGain>().setGainLinear(gain);
+}
+
+float ReferenceEngine::wrap(float x, int fs)
+{
+    float y;
+
+    if (x > fs / 2)
+        y = x - int(ceil( x )) % fs;
+
+    else if (x < 20)
+        y = 20 - x + 20;
+
+    else
+        y = x;
+
+    return y;
+}
+
+float ReferenceEngine::getCurFreq(const ChainSettings& chainSettings, int harm)
+{
+    float fc, detune, freqModVal;
+
+    fc = chainSettings.freq;
+
+    freqModVal = chainSettings.modFreq ? modVector[size_t(harm)] : 0.f;
+
+    if (harm > 0)
+    {
+        detune = chainSettings.detune;
+
+        if (chainSettings.modDetune)
+            detune += (modVector[size_t(harm)] / 200.f);
+    }
+    else
+        detune = 1;
+
+    detune = detune == 0 ? 0.1f : detune;
+
+    return (freqModVal + 1.f) * fc * pow(float(harm + 1), detune);
+}
+
+//==============================================================================
+void ProcessorEngine::prepare(double sampleRate, int newBlockSize)
+{
+    blockSize = newBlockSize;
+
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+}
+
+void ProcessorEngine::render(juce::AudioBuffer<float>& buffer, const ChainSettings& settings)
+{
+    juce::MidiBuffer midi;
+
+    setChainSettings(processor.apvts, settings);
+
+    for (int start = 0; start < buffer.getNumSamples(); start += blockSize)
+    {
+        int len = juce::jmin(blockSize, buffer.getNumSamples() - start);
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, len);
+        processor.processBlock(block, midi);
+    }
+}
+
+//==============================================================================
+juce::AudioBuffer<float> makeTestSignal(TestSignal signal, double sampleRate, int numSamples)
+{
+    juce::AudioBuffer<float> buffer(2, numSamples);
+    buffer.clear();
+
+    auto* data = buffer.getWritePointer(LEFT_CHANNEL);
+
+    switch (signal)
+    {
+        case TestSignal::impulse:
+            data[0] = 1.f;
+            break;
+
+        case TestSignal::sweep:
+        {
+            // exponential sine sweep, 20 Hz to 20 kHz
+            double f0 = 20.0, f1 = 20000.0;
+            double length = numSamples / sampleRate;
+            double k = std::log(f1 / f0);
+
+            for (int n = 0; n < numSamples; n++)
+            {
+                double t = n / sampleRate;
+                double phase = juce::MathConstants<double>::twoPi * f0 * length / k * (std::exp(t * k / length) - 1.0);
+                data[n] = 0.5f * float(std::sin(phase));
+            }
+            break;
+        }
+
+        case TestSignal::noise:
+        {
+            juce::Random random(0x5eed);
+
+            for (int n = 0; n < numSamples; n++)
+                data[n] = random.nextFloat() - 0.5f;
+            break;
+        }
+
+        case TestSignal::transient:
+        {
+            // decaying noise bursts every 100 ms
+            juce::Random random(0xb0057);
+            int period = int(sampleRate * 0.1);
+
+            for (int n = 0; n < numSamples; n++)
+            {
+                float env = std::exp(-float(n % period) / float(sampleRate * 0.005));
+                data[n] = env * (random.nextFloat() * 2.f - 1.f);
+            }
+            break;
+        }
+    }
+
+    buffer.copyFrom(RIGHT_CHANNEL, 0, buffer, LEFT_CHANNEL, 0, numSamples);
+
+    return buffer;
+}
+
+std::vector<ChainSettings> makeParameterMatrix()
+{
+    const int qualities[] = {0, 1, 2};
+    const float qs[] = {1.f, 20.f, 100.f};
+    const float detunes[] = {0.5f, 1.f, 2.f};
+    const float curves[] = {0.1f, 1.f, 10.f};
+    const float timbres[] = {0.f, 0.5f, 1.f};
+
+    std::vector<ChainSettings> matrix;
+
+    for (int quality : qualities)
+        for (float q : qs)
+            for (float detune : detunes)
+                for (float curve : curves)
+                    for (float timbre : timbres)
+                        for (int modMode = 0; modMode < 3; modMode++)
+                        {
+                            ChainSettings settings;
+
+                            settings.timbre = timbre;
+                            settings.freq = 100.f;
+                            settings.q = q;
+                            settings.stereoLink = 1.f;
+                            settings.quality = quality;
+                            settings.curve = curve;
+                            settings.detune = detune;
+                            settings.modFreq = modMode == 1;
+                            settings.modDetune = modMode == 2;
+                            settings.modRate = 1.f;
+                            settings.modDepth = modMode == 0 ? 0.f : 50.f;
+
+                            matrix.push_back(settings);
+                        }
+
+    return matrix;
+}
+
+//==============================================================================
+static void compareBuffers(const juce::AudioBuffer<float>& reference,
+                           const juce::AudioBuffer<float>& test,
+                           GoldenResult& result)
+{
+    double refEnergy = 0, errEnergy = 0;
+    float maxError = 0;
+
+    for (int chan = 0; chan < reference.getNumChannels(); chan++)
+    {
+        auto* ref = reference.getReadPointer(chan);
+        auto* out = test.getReadPointer(chan);
+
+        for (int n = 0; n < reference.getNumSamples(); n++)
+        {
+            float err = out[n] - ref[n];
+
+            refEnergy += double(ref[n]) * ref[n];
+            errEnergy += double(err) * err;
+            maxError = juce::jmax(maxError, std::abs(err));
+        }
+    }
+
+    result.errorDb = float(10.0 * std::log10((errEnergy + 1.0e-20) / (refEnergy + 1.0e-20)));
+    result.maxSampleError = maxError;
+}
+
+std::vector<EngineEntry> makeDefaultEngines()
+{
+    // The upper bands run at Q of several thousand, where a one-ulp change in
+    // a coefficient already leaves around -70 dB of residual, so the default
+    // tolerance is what "equivalent to float rounding" means for this bank.
+    // The bank's per-harmonic LFOs (ModBank) run at the real Mod Rate, so
+    // its modulated renders are measured against the reference with the
+    // bank's LFO rather than the original's.
+    EngineTolerance tolerance;
+
+    return { { "processor", [] { return std::make_unique<ProcessorEngine>(); }, tolerance, false } };
+}
+
+std::vector<GoldenResult> runGoldenComparison(const std::vector<EngineEntry>& engines,
+                                              double sampleRate,
+                                              int blockSize,
+                                              int numSamples,
+                                              int numThreads)
+{
+    const TestSignal signals[] = { TestSignal::impulse, TestSignal::sweep, TestSignal::noise, TestSignal::transient };
+    const int numSignals = juce::numElementsInArray(signals);
+
+    auto matrix = makeParameterMatrix();
+    int numEngines = int(engines.size());
+
+    std::vector<GoldenResult> results(matrix.size() * numSignals * numEngines);
+
+    if (numThreads <= 0)
+        numThreads = juce::SystemStats::getNumCpus();
+
+    juce::ThreadPool pool(numThreads);
+    juce::WaitableEvent finished;
+    std::atomic<int> remaining {int(matrix.size())};
+
+    for (size_t entry = 0; entry < matrix.size(); entry++)
+    {
+        pool.addJob([&, entry]
+        {
+            const auto& settings = matrix[entry];
+            const bool modulated = settings.modFreq || settings.modDetune;
+
+            // every job owns its engines, so no state is shared between
+            // workers; the references with the bank's LFO and the original's
+            std::unique_ptr<ReferenceEngine> references[2] { std::make_unique<ReferenceEngine>(false),
+                                                             std::make_unique<ReferenceEngine>(true) };
+
+            for (auto& reference : references)
+                reference->prepare(sampleRate, blockSize);
+
+            std::vector<std::unique_ptr<HarnessEngine>> testEngines;
+            for (const auto& engine : engines)
+            {
+                testEngines.push_back(engine.create());
+                testEngines.back()->prepare(sampleRate, blockSize);
+            }
+
+            for (int sig = 0; sig < numSignals; sig++)
+            {
+                auto input = makeTestSignal(signals[sig], sampleRate, numSamples);
+
+                // unmodulated the two render the same, so the original's serves
+                juce::AudioBuffer<float> goldens[2];
+                bool rendered[2] {};
+
+                auto getGolden = [&] (bool legacy) -> const juce::AudioBuffer<float>&
+                {
+                    const int kind = legacy || ! modulated ? 1 : 0;
+
+                    if (! rendered[kind])
+                    {
+                        goldens[kind].makeCopyOf(input);
+                        references[kind]->render(goldens[kind], settings);
+                        rendered[kind] = true;
+                    }
+
+                    return goldens[kind];
+                };
+
+                for (int e = 0; e < numEngines; e++)
+                {
+                    auto& result = results[(entry * numSignals + sig) * numEngines + e];
+
+                    result.engine = engines[e].name;
+                    result.signal = signals[sig];
+                    result.settings = settings;
+
+                    juce::AudioBuffer<float> output;
+                    output.makeCopyOf(input);
+                    testEngines[e]->render(output, settings);
+
+                    compareBuffers(getGolden(engines[e].legacyModulation), output, result);
+                    result.passed = result.errorDb <= engines[e].tolerance.maxErrorDb
+                                 && result.maxSampleError <= engines[e].tolerance.maxSampleError;
+                }
+            }
+
+            if (--remaining == 0)
+                finished.signal();
+        });
+    }
+
+    if (! matrix.empty())
+        finished.wait();
+
+    return results;
+}
+
+juce::String describeResult(const GoldenResult& result)
+{
+    const char* signalNames[] = { "impulse", "sweep", "noise", "transient" };
+    const auto& s = result.settings;
+
+    return result.engine
+        + (result.passed ? " PASS " : " FAIL ")
+        + signalNames[int(result.signal)]
+        + " quality=" + juce::String(s.quality)
+        + " q=" + juce::String(s.q)
+        + " detune=" + juce::String(s.detune)
+        + " curve=" + juce::String(s.curve)
+        + " timbre=" + juce::String(s.timbre)
+        + " modFreq=" + juce::String(int(s.modFreq))
+        + " modDetune=" + juce::String(int(s.modDetune))
+        + " error=" + juce::String(result.errorDb, 1) + " dB"
+        + " maxSample=" + juce::String(result.maxSampleError, 6);
+}
+
+//==============================================================================
+ColdStartTimes measureColdStart(int numInstances, double sampleRate, int blockSize)
+{
+    ColdStartTimes times;
+
+    auto start = juce::Time::getHighResolutionTicks();
+    {
+        std::vector<std::unique_ptr<HarmonicBank>> banks;
+
+        for (int i = 0; i < numInstances; i++)
+        {
+            banks.push_back(std::make_unique<HarmonicBank>());
+            banks.back()->prepare(sampleRate, blockSize, 2);
+        }
+    }
+    auto mid = juce::Time::getHighResolutionTicks();
+    {
+        std::vector<std::unique_ptr<ThesisAudioProcessor>> plugins;
+
+        for (int i = 0; i < numInstances; i++)
+        {
+            plugins.push_back(std::make_unique<ThesisAudioProcessor>());
+            plugins.back()->setRateAndBufferSizeDetails(sampleRate, blockSize);
+            plugins.back()->prepareToPlay(sampleRate, blockSize);
+        }
+    }
+    auto end = juce::Time::getHighResolutionTicks();
+
+    times.bankMicros = juce::Time::highResolutionTicksToSeconds(mid - start) * 1.0e6 / numInstances;
+    times.pluginMicros = juce::Time::highResolutionTicksToSeconds(end - mid) * 1.0e6 / numInstances;
+
+    return times;
+}
+
+ReprepareTimes measureReprepare(int numInstances, double sampleRate, int blockSize)
+{
+    std::vector<std::unique_ptr<ThesisAudioProcessor>> plugins;
+
+    for (int i = 0; i < numInstances; i++)
+    {
+        plugins.push_back(std::make_unique<ThesisAudioProcessor>());
+        plugins.back()->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        plugins.back()->prepareToPlay(sampleRate, blockSize);
+    }
+
+    auto timePrepare = [&plugins, numInstances](double rate, int size)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (auto& plugin : plugins)
+        {
+            plugin->setRateAndBufferSizeDetails(rate, size);
+            plugin->prepareToPlay(rate, size);
+        }
+
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e6 / numInstances;
+    };
+
+    ReprepareTimes times;
+    times.unchangedMicros = timePrepare(sampleRate, blockSize);
+    times.largerBlockMicros = timePrepare(sampleRate, 2 * blockSize);
+    times.smallerBlockMicros = timePrepare(sampleRate, blockSize);
+    times.newRateMicros = timePrepare(sampleRate == 44100.0 ? 48000.0 : 44100.0, blockSize);
+
+    return times;
+}
+
+StreamThroughput measureStreamThroughput(int numStreams, double sampleRate, int blockSize, int numBlocks)
+{
+    juce::AudioBuffer<float> input(2 * numStreams, blockSize), buffer(2 * numStreams, blockSize);
+    juce::Random random(0x5eed);
+
+    for (int chan = 0; chan < input.getNumChannels(); chan++)
+        for (int n = 0; n < blockSize; n++)
+            input.setSample(chan, n, random.nextFloat() - 0.5f);
+
+    std::vector<std::unique_ptr<ThesisAudioProcessor>> plugins;
+    ChainSettings settings;
+
+    for (int i = 0; i < numStreams; i++)
+    {
+        plugins.push_back(std::make_unique<ThesisAudioProcessor>());
+
+        settings = getChainSettings(plugins.back()->apvts);
+        settings.governor = false;
+        settings.culling = false;
+        setChainSettings(plugins.back()->apvts, settings);
+
+        plugins.back()->setRateAndBufferSizeDetails(sampleRate, blockSize);
+        plugins.back()->prepareToPlay(sampleRate, blockSize);
+    }
+
+    MultiStreamBank multi;
+    multi.setSettings(settings);
+    multi.prepare(sampleRate, blockSize, numStreams, 2);
+
+    juce::MidiBuffer midi;
+
+    auto start = juce::Time::getHighResolutionTicks();
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        buffer.makeCopyOf(input, true);
+
+        for (int i = 0; i < numStreams; i++)
+        {
+            juce::AudioBuffer<float> stream(buffer.getArrayOfWritePointers() + 2 * i, 2, blockSize);
+            plugins[size_t(i)]->processBlock(stream, midi);
+        }
+    }
+
+    auto mid = juce::Time::getHighResolutionTicks();
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        buffer.makeCopyOf(input, true);
+        multi.process(buffer.getArrayOfWritePointers(), blockSize);
+    }
+
+    auto end = juce::Time::getHighResolutionTicks();
+
+    const double perStreamBlock = 1.0e6 / (double(numStreams) * numBlocks);
+
+    StreamThroughput result;
+    result.numStreams = numStreams;
+    result.processorMicros = juce::Time::highResolutionTicksToSeconds(mid - start) * perStreamBlock;
+    result.multiStreamMicros = juce::Time::highResolutionTicksToSeconds(end - mid) * perStreamBlock;
+
+    return result;
+}
+
+//==============================================================================
+RealtimeDriveResult driveUnderRealtimeCheck(int numBlocks, double sampleRate)
+{
+    const int blockSizes[] = { 512, 64, 1024, 128, 480 };
+    const int numBlockSizes = juce::numElementsInArray(blockSizes);
+    const int blocksPerSize = juce::jmax(1, numBlocks / numBlockSizes);
+
+    RealtimeDriveResult result;
+    result.checked = THESIS_RT_CHECK != 0;
+
+    ThesisAudioProcessor processor;
+    juce::MidiBuffer midi;
+    juce::Random random(0x5afe);
+
+    // Three presets: the defaults, a partial map, and the top Quality on
+    // the modal engine with oversampling and modulation on. Loading them in
+    // turn switches the map on and off and moves every setting prepare
+    // sized for, as a user browsing presets does.
+    std::vector<juce::MemoryBlock> presets(3);
+    processor.getStateInformation(presets[0]);
+
+    juce::TemporaryFile mapFile(".thpm");
+    std::vector<Partial> partials;
+
+    for (int i = 1; i <= 400; i++)
+    {
+        Partial partial;
+        partial.ratio = float(i) * std::sqrt(1.f + 0.0004f * float(i * i));     // a stiff string
+        partial.gain = 1.f / float(i);
+        partials.push_back(partial);
+    }
+
+    if (! PartialMap::write(mapFile.getFile().getFullPathName().toStdString(), partials)
+        || ! processor.loadPartialMap(mapFile.getFile()))
+        jassertfalse;
+
+    processor.getStateInformation(presets[1]);
+    processor.clearPartialMap();
+
+    auto settings = getChainSettings(processor.apvts);
+    settings.quality = MAX_QUALITY;
+    settings.engine = ENGINE_MODAL;
+    settings.oversampling = 1;
+    settings.modFreq = true;
+    settings.modDetune = true;
+    settings.modSpread = 0.5f;
+    setChainSettings(processor.apvts, settings);
+
+    processor.getStateInformation(presets[2]);
+    processor.setStateInformation(presets[0].getData(), int(presets[0].getSize()));
+
+    // preset loads race the audio thread, as they do in a host
+    std::atomic<bool> loading {true};
+    std::atomic<int> numLoads {0};
+    std::thread presetThread([&]
+    {
+        while (loading)
+        {
+            const auto& preset = presets[size_t(numLoads % int(presets.size()))];
+            processor.setStateInformation(preset.getData(), int(preset.getSize()));
+            numLoads++;
+            juce::Thread::sleep(2);
+        }
+    });
+
+    resetRealtimeViolations();
+
+    int maxBlockSize = 0;
+    juce::AudioBuffer<float> buffer;
+
+    for (int n = 0; n < numBlocks; n++)
+    {
+        // everything outside processBlock plays the host's message thread
+        if (n % blocksPerSize == 0)
+        {
+            maxBlockSize = blockSizes[(n / blocksPerSize) % numBlockSizes];
+
+            processor.releaseResources();
+            processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+            processor.prepareToPlay(sampleRate, maxBlockSize);
+
+            buffer.setSize(2, maxBlockSize);
+        }
+
+        auto set = [&processor](const juce::String& paramID, float value)
+        {
+            auto* param = processor.apvts.getParameter(paramID);
+            param->setValueNotifyingHost(param->convertTo0to1(value));
+        };
+
+        set("Center Frequency", 50.f + float(n % 200) * 10.f);
+        if (n % 50 == 0)
+        {
+            // past 2 through Extended Quality, which prepare made room for
+            int quality = (n / 50) % (MAX_QUALITY + 1);
+            set("Quality", float(juce::jmin(quality, 2)));
+            set("Extended Quality", float(juce::jmax(quality - 2, 0)));
+        }
+        if (n % 70 == 0)
+            set("Mod Freq", float((n / 70) % 2));
+        if (n % 90 == 0)
+            set("Mod Detune", float((n / 90) % 2));
+
+        // hosts may hand over any size up to the prepared maximum
+        int numSamples = 1 + random.nextInt(maxBlockSize);
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), 2, numSamples);
+        for (int chan = 0; chan < 2; chan++)
+            for (int i = 0; i < numSamples; i++)
+                block.setSample(chan, i, random.nextFloat() - 0.5f);
+
+        processBlockAsHost(processor, block, midi);
+        result.numBlocks++;
+
+        dispatchPendingMessages(0);
+    }
+
+    loading = false;
+    presetThread.join();
+
+    result.numPresetLoads = numLoads;
+    result.violations = getRealtimeViolationCount();
+
+    return result;
+}
+
+//==============================================================================
+void processBlockAsHost(juce::AudioProcessor& processor, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
+{
+    const juce::ScopedLock lock(processor.getCallbackLock());
+
+    if (processor.isSuspended())
+        buffer.clear();
+    else
+        processor.processBlock(buffer, midi);
+}
+
+void dispatchPendingMessages(int milliseconds)
+{
+   #if JUCE_MODAL_LOOPS_PERMITTED
+    auto* messageManager = juce::MessageManager::getInstanceWithoutCreating();
+
+    if (messageManager != nullptr && messageManager->isThisTheMessageThread())
+    {
+        messageManager->runDispatchLoopUntil(milliseconds);
+        return;
+    }
+   #endif
+
+    juce::Thread::sleep(milliseconds);
+}
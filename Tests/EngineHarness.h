@@ -0,0 +1,218 @@
+/*
+  ==============================================================================
+
+    EngineHarness.h
+    Created: 19 Oct 2026 9:14:22am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+/*
+    Golden-output harness: renders fixed test signals through the reference
+    BPChain bank and through any alternative engine, over a matrix of
+    parameter settings, and reports how far each engine strays from the
+    reference. Everything here runs headless, so it can be driven from a
+    console host or CI job without an audio device or editor.
+*/
+
+enum class TestSignal
+{
+    impulse,
+    sweep,
+    noise,
+    transient
+};
+
+struct EngineTolerance
+{
+    float maxErrorDb {-60.f};       // residual energy relative to the reference
+    float maxSampleError {1.0e-3f}; // largest absolute per-sample difference
+};
+
+//==============================================================================
+class HarnessEngine
+{
+public:
+    virtual ~HarnessEngine() {}
+
+    virtual void prepare(double sampleRate, int blockSize) = 0;
+
+    // render the whole buffer in place, in chunks of the prepared block size
+    virtual void render(juce::AudioBuffer<float>& buffer, const ChainSettings& settings) = 0;
+};
+
+#define REFERENCE_HARM  200     // the original bank's fixed count, Quality 2
+
+// The reference path: the original per-harmonic juce::dsp::ProcessorChain bank
+// that processBlock ran before the DSP moved into HarmonicBank. It is kept
+// here unchanged as the golden output every engine is measured against, so
+// it only covers Quality 0 to 2.
+//
+// Its LFO is either the original's (legacyModulation): harmonic h holds the
+// Modulator's output at sample h of each block. Or it is the bank's with
+// both spreads at 0: a single ModBank oscillator whose value at the start
+// of each block every harmonic holds.
+class ReferenceEngine : public HarnessEngine
+{
+public:
+    explicit ReferenceEngine(bool legacyModulation = true) : legacyModulation(legacyModulation) {}
+
+    void prepare(double sampleRate, int blockSize) override;
+    void render(juce::AudioBuffer<float>& buffer, const ChainSettings& settings) override;
+
+private:
+    void processBlock(juce::AudioBuffer<float>& buffer, const ChainSettings& chainSettings);
+    void processWithMod(juce::AudioBuffer<float>& buffer, const ChainSettings& chainSettings, int harm);
+    void processNoMod(juce::AudioBuffer<float>& buffer, int harm);
+
+    float wrap(float x, int sampleRate);
+    float getCurFreq(const ChainSettings& chainSettings, int harm);
+
+    void updateAll(const ChainSettings& chainSettings);
+    bool updateSVFilter(const ChainSettings& chainSettings, int i);
+    void updateCurveGain(const ChainSettings& chainSettings, int i);
+    void updateOddEvenGain(const ChainSettings& chainSettings, int i);
+
+    using SVFilter = juce::dsp::StateVariableTPTFilter<float>;
+    using Gain = juce::dsp::Gain<float>;
+    using BPChain = juce::dsp::ProcessorChain<SVFilter, Gain, Gain>;
+
+    enum BPChainPositions
+    {
+        BPFilter,
+        CurveGain,
+        OddEvenGain
+    };
+
+    BPChain leftChain[REFERENCE_HARM], rightChain[REFERENCE_HARM];
+
+    Modulator mod;
+    ModBank lfo;
+    std::vector<float> modVector;
+    bool legacyModulation {true};
+
+    double sampleRate {44100.0};
+    int blockSize {512};
+};
+
+// A complete ThesisAudioProcessor driven through processBlock.
+class ProcessorEngine : public HarnessEngine
+{
+public:
+    void prepare(double sampleRate, int blockSize) override;
+    void render(juce::AudioBuffer<float>& buffer, const ChainSettings& settings) override;
+
+private:
+    ThesisAudioProcessor processor;
+    int blockSize {512};
+};
+
+struct EngineEntry
+{
+    juce::String name;
+    std::function<std::unique_ptr<HarnessEngine>()> create;
+    EngineTolerance tolerance;
+
+    // false for engines whose LFO no longer follows the original modBlock
+    // sampling; their modulated entries are measured against the reference
+    // with the bank's LFO instead
+    bool legacyModulation {true};
+};
+
+struct GoldenResult
+{
+    juce::String engine;
+    TestSignal signal;
+    ChainSettings settings;
+    float errorDb {0};
+    float maxSampleError {0};
+    bool passed {false};
+};
+
+//==============================================================================
+juce::AudioBuffer<float> makeTestSignal(TestSignal signal, double sampleRate, int numSamples);
+
+// Quality x Q x Detune x Curve x Timbre x {no mod, mod freq, mod detune}
+std::vector<ChainSettings> makeParameterMatrix();
+
+// The shipping processor, which should match the reference to float rounding.
+std::vector<EngineEntry> makeDefaultEngines();
+
+// Renders every matrix entry and test signal through the reference and each
+// engine, spreading the matrix across numThreads workers (0 = one per core).
+std::vector<GoldenResult> runGoldenComparison(const std::vector<EngineEntry>& engines,
+                                              double sampleRate = 48000.0,
+                                              int blockSize = 512,
+                                              int numSamples = 8192,
+                                              int numThreads = 0);
+
+juce::String describeResult(const GoldenResult& result);
+
+//==============================================================================
+struct ColdStartTimes
+{
+    double bankMicros {0};      // HarmonicBank construction + prepare, per instance
+    double pluginMicros {0};    // ThesisAudioProcessor construction + prepareToPlay, per instance
+};
+
+ColdStartTimes measureColdStart(int numInstances = 100, double sampleRate = 48000.0, int blockSize = 512);
+
+// prepareToPlay again on processors that have been prepared once, per instance
+struct ReprepareTimes
+{
+    double unchangedMicros {0};     // the same rate and block size, as hosts do on every bounce
+    double largerBlockMicros {0};   // twice the block size
+    double smallerBlockMicros {0};  // back to the original block size
+    double newRateMicros {0};       // another sample rate
+};
+
+ReprepareTimes measureReprepare(int numInstances = 100, double sampleRate = 48000.0, int blockSize = 512);
+
+// numStreams stereo noise signals at the default settings, with the CPU
+// governor and culling off, through a ThesisAudioProcessor each and through
+// one MultiStreamBank, in microseconds per stream per block
+struct StreamThroughput
+{
+    int numStreams {0};
+    double processorMicros {0};
+    double multiStreamMicros {0};
+};
+
+StreamThroughput measureStreamThroughput(int numStreams = 64, double sampleRate = 48000.0, int blockSize = 512,
+                                         int numBlocks = 200);
+
+//==============================================================================
+struct RealtimeDriveResult
+{
+    bool checked {false};       // false unless built with THESIS_RT_CHECK
+    int numBlocks {0};
+    int numPresetLoads {0};
+    int violations {0};         // reported inside processBlock (see RealtimeCheck.h)
+};
+
+// Drives a processor through parameter automation (Quality up to
+// MAX_QUALITY, through Extended Quality), block-size changes and
+// re-prepares while another thread keeps loading presets (the defaults, a
+// partial map, and the top Quality on the modal engine), and counts what
+// the realtime checker reports inside processBlock. Call it from the
+// message thread, which it pumps between blocks. A clean run has no
+// violations.
+RealtimeDriveResult driveUnderRealtimeCheck(int numBlocks = 4000, double sampleRate = 48000.0);
+
+//==============================================================================
+// What a host's plugin wrapper does around processBlock: it holds the
+// callback lock, and while the processor is suspended it outputs silence
+// instead of calling it.
+void processBlockAsHost(juce::AudioProcessor& processor, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi);
+
+// Delivers what was posted to the message thread (the parameters' and the
+// state's async updates) for up to milliseconds, 0 for at most one message. Off the
+// message thread, or in builds without JUCE_MODAL_LOOPS_PERMITTED, it only
+// waits, for whichever thread runs the message loop.
+void dispatchPendingMessages(int milliseconds);
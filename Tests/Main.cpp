@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 26 Oct 2026 10:12:40am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "EngineHarness.h"
+#include "../Source/SessionRecorder.h"
+#include "SoakHarness.h"
+
+/*
+    Headless test runner for CI: the golden comparison, a realtime-checked
+    drive, a soak run and a session replay, one after the other. It exits
+    with 1 if any of them fails.
+
+        ThesisTests [--soak=seconds] [--replay=capture.thsc]
+
+    The soak runs for 30 s unless told otherwise. Without --replay it
+    captures a short session of its own and replays that.
+
+    CMake builds it as ThesisTests, with the realtime checker and modal
+    loops on, once it can find JUCE; ctest runs it with a 10 s soak:
+
+        cmake -S . -B build -DTHESIS_JUCE_DIR=/path/to/JUCE
+        cmake --build build --target ThesisTests
+        ctest --test-dir build --output-on-failure
+*/
+
+#define TEST_SOAK_SECONDS       30.0
+#define TEST_CAPTURE_BLOCKS     400
+
+static bool report(const juce::String& name, bool passed, const juce::String& detail = {})
+{
+    std::cout << (passed ? "PASS " : "FAIL ") << name;
+
+    if (detail.isNotEmpty())
+        std::cout << ": " << detail;
+
+    std::cout << std::endl;
+
+    return passed;
+}
+
+static bool testGolden()
+{
+    int numFailed = 0;
+    auto results = runGoldenComparison(makeDefaultEngines());
+
+    for (const auto& result : results)
+    {
+        if (! result.passed)
+        {
+            numFailed++;
+            std::cout << describeResult(result) << std::endl;
+        }
+    }
+
+    return report("golden comparison", numFailed == 0,
+                  juce::String(int(results.size())) + " renders, " + juce::String(numFailed) + " failed");
+}
+
+static bool testRealtime()
+{
+    auto result = driveUnderRealtimeCheck();
+
+    if (! result.checked)
+        return report("realtime check", false, "built without THESIS_RT_CHECK");
+
+    return report("realtime check", result.violations == 0,
+                  juce::String(result.numBlocks) + " blocks, " + juce::String(result.numPresetLoads)
+                  + " preset loads, " + juce::String(result.violations) + " violations");
+}
+
+static bool testSoak(double seconds)
+{
+    SoakConfig config;
+    config.seconds = seconds;
+    config.reportInterval = 0;
+
+    auto result = runSoakTest(config, juce::File());
+    std::cout << describeSoakReport(result) << std::endl;
+
+    // without SCHED_FIFO the scheduler decides, so misses only count with it
+    bool passed = result.violations == 0 && (! result.realtime || result.deadlineMisses == 0);
+
+    return report("soak", passed,
+                  juce::String(result.numBlocks) + " blocks, " + juce::String(result.deadlineMisses)
+                  + " misses, " + juce::String(result.violations) + " violations");
+}
+
+// a few seconds of automated noise through a processor, captured to file;
+// halfway through it loads a partial map, which the replay has to load too
+static bool captureSession(const juce::File& file, const juce::File& mapFile)
+{
+    std::vector<Partial> partials;
+
+    for (int i = 1; i <= 64; i++)
+    {
+        Partial partial;
+        partial.ratio = float(i) * std::sqrt(1.f + 0.0004f * float(i * i));
+        partials.push_back(partial);
+    }
+
+    if (! PartialMap::write(mapFile.getFullPathName().toStdString(), partials))
+        return false;
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 256;
+
+    ThesisAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    if (! processor.startCapture(file, true))
+        return false;
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(0xca97);
+
+    for (int n = 0; n < TEST_CAPTURE_BLOCKS; n++)
+    {
+        if (n == TEST_CAPTURE_BLOCKS / 2 && ! processor.loadPartialMap(mapFile))
+            return false;
+
+        auto* param = processor.apvts.getParameter("Center Frequency");
+        param->setValueNotifyingHost(param->convertTo0to1(50.f + float(n % 100) * 20.f));
+
+        for (int chan = 0; chan < 2; chan++)
+            for (int i = 0; i < blockSize; i++)
+                buffer.setSample(chan, i, random.nextFloat() - 0.5f);
+
+        processBlockAsHost(processor, buffer, midi);
+        dispatchPendingMessages(0);
+    }
+
+    processor.stopCapture();
+    processor.releaseResources();
+
+    return true;
+}
+
+static bool testReplay(juce::File file)
+{
+    juce::TemporaryFile capture(".thsc"), mapFile(".thpm");
+
+    if (file == juce::File())
+    {
+        file = capture.getFile();
+
+        if (! captureSession(file, mapFile.getFile()))
+            return report("replay", false, "could not capture to " + file.getFullPathName());
+    }
+
+    auto result = replaySession(file);
+    std::cout << describeReplay(result) << std::endl;
+
+    if (! result.loaded)
+        return report("replay", false, result.error);
+
+    return report("replay", ! result.blockSizes.empty() && result.warning.isEmpty(),
+                  juce::String(int(result.blockSizes.size())) + " blocks");
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // the processors post to the message thread, which is this one
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    double soakSeconds = TEST_SOAK_SECONDS;
+    juce::File replayFile;
+
+    if (args.containsOption("--soak"))
+        soakSeconds = args.getValueForOption("--soak").getDoubleValue();
+
+    if (args.containsOption("--replay"))
+        replayFile = args.getFileForOption("--replay");
+
+    bool passed = true;
+
+    passed &= testGolden();
+    passed &= testRealtime();
+    passed &= testSoak(soakSeconds);
+    passed &= testReplay(replayFile);
+
+    std::cout << (passed ? "all tests passed" : "tests FAILED") << std::endl;
+
+    return passed ? 0 : 1;
+}
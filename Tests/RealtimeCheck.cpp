@@ -0,0 +1,410 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 20 Oct 2026 4:05:41pm
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "../Source/RealtimeCheck.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+static std::atomic<int> violationCount {0};
+static std::atomic<bool> fatal {false};
+
+int getRealtimeViolationCount()
+{
+    return violationCount.load();
+}
+
+void resetRealtimeViolations()
+{
+    violationCount = 0;
+}
+
+void setRealtimeCheckFatal(bool shouldAbort)
+{
+    fatal = shouldAbort;
+}
+
+#if THESIS_RT_CHECK
+
+#if defined(__linux__)
+ #define RT_CHECK_INTERPOSE 1
+ #include <cstdarg>
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <fcntl.h>
+ #include <malloc.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+
+ // the allocator itself touches these, so they must never need a lazy TLS
+ // allocation of their own
+ #define RT_TLS __attribute__((tls_model("initial-exec"))) thread_local
+#else
+ #define RT_CHECK_INTERPOSE 0
+ #if defined(__APPLE__)
+  #include <execinfo.h>
+  #include <unistd.h>
+ #elif defined(_WIN32)
+  #include <malloc.h>
+ #endif
+ #define RT_TLS thread_local
+#endif
+
+#define RT_MAX_FRAMES   48
+
+static RT_TLS int regionDepth = 0;
+static RT_TLS int allowDepth = 0;
+static RT_TLS bool reporting = false;
+
+ScopedRealtimeRegion::ScopedRealtimeRegion()    { regionDepth++; }
+ScopedRealtimeRegion::~ScopedRealtimeRegion()   { regionDepth--; }
+
+ScopedRealtimeAllow::ScopedRealtimeAllow()      { allowDepth++; }
+ScopedRealtimeAllow::~ScopedRealtimeAllow()     { allowDepth--; }
+
+static bool inRealtimeRegion()
+{
+    return regionDepth > 0 && allowDepth == 0 && ! reporting;
+}
+
+static void reportViolation(const char* what)
+{
+    // anything the report itself does must not be reported again
+    reporting = true;
+    violationCount++;
+
+   #if defined(__linux__) || defined(__APPLE__)
+    const char heading[] = "*** audio thread called ";
+    (void) ::write(2, heading, sizeof(heading) - 1);
+    (void) ::write(2, what, std::strlen(what));
+    (void) ::write(2, "\n", 1);
+
+    void* frames[RT_MAX_FRAMES];
+    int numFrames = backtrace(frames, RT_MAX_FRAMES);
+    backtrace_symbols_fd(frames, numFrames, 2);
+   #endif
+
+    if (fatal)
+        std::abort();
+
+    reporting = false;
+}
+
+//==============================================================================
+#if RT_CHECK_INTERPOSE
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* ptr);
+}
+
+static void* rawMalloc(size_t size)                             { return __libc_malloc(size); }
+static void* rawAlignedMalloc(size_t size, size_t alignment)    { return __libc_memalign(alignment, size); }
+static void rawFree(void* ptr)                                  { __libc_free(ptr); }
+static void rawAlignedFree(void* ptr)                           { __libc_free(ptr); }
+
+// first use resolves the next definition; no function-local statics, since
+// their guards may lock
+template <typename Function>
+static Function resolveNext(Function& cached, const char* name)
+{
+    if (cached == nullptr)
+        cached = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+
+    return cached;
+}
+
+extern "C" {
+
+void* malloc(size_t size)
+{
+    if (inRealtimeRegion())
+        reportViolation("malloc");
+
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    if (inRealtimeRegion())
+        reportViolation("calloc");
+
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    if (inRealtimeRegion())
+        reportViolation("realloc");
+
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+    if (ptr != nullptr && inRealtimeRegion())
+        reportViolation("free");
+
+    __libc_free(ptr);
+}
+
+static void* (*realAlignedAlloc)(size_t, size_t) = nullptr;
+static int (*realPosixMemalign)(void**, size_t, size_t) = nullptr;
+static void* (*realMemalign)(size_t, size_t) = nullptr;
+static int (*realMutexLock)(pthread_mutex_t*) = nullptr;
+static int (*realCondWait)(pthread_cond_t*, pthread_mutex_t*) = nullptr;
+static int (*realCondTimedwait)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*) = nullptr;
+static int (*realCondClockwait)(pthread_cond_t*, pthread_mutex_t*, clockid_t, const struct timespec*) = nullptr;
+static int (*realOpen)(const char*, int, ...) = nullptr;
+static ssize_t (*realRead)(int, void*, size_t) = nullptr;
+static ssize_t (*realWrite)(int, const void*, size_t) = nullptr;
+static int (*realPoll)(struct pollfd*, nfds_t, int) = nullptr;
+static int (*realFsync)(int) = nullptr;
+static int (*realUsleep)(useconds_t) = nullptr;
+static int (*realNanosleep)(const struct timespec*, struct timespec*) = nullptr;
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    if (inRealtimeRegion())
+        reportViolation("aligned_alloc");
+
+    return resolveNext(realAlignedAlloc, "aligned_alloc")(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    if (inRealtimeRegion())
+        reportViolation("posix_memalign");
+
+    return resolveNext(realPosixMemalign, "posix_memalign")(ptr, alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    if (inRealtimeRegion())
+        reportViolation("memalign");
+
+    return resolveNext(realMemalign, "memalign")(alignment, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    if (inRealtimeRegion())
+        reportViolation("pthread_mutex_lock");
+
+    return resolveNext(realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+{
+    if (inRealtimeRegion())
+        reportViolation("pthread_cond_wait");
+
+    return resolveNext(realCondWait, "pthread_cond_wait")(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* deadline)
+{
+    if (inRealtimeRegion())
+        reportViolation("pthread_cond_timedwait");
+
+    return resolveNext(realCondTimedwait, "pthread_cond_timedwait")(cond, mutex, deadline);
+}
+
+// what std::condition_variable's timed waits call with glibc 2.30 and later
+int pthread_cond_clockwait(pthread_cond_t* cond, pthread_mutex_t* mutex, clockid_t clock,
+                           const struct timespec* deadline)
+{
+    if (inRealtimeRegion())
+        reportViolation("pthread_cond_clockwait");
+
+    return resolveNext(realCondClockwait, "pthread_cond_clockwait")(cond, mutex, clock, deadline);
+}
+
+int open(const char* path, int flags, ...)
+{
+    if (inRealtimeRegion())
+        reportViolation("open");
+
+    // the mode is only passed when the file may be created
+    mode_t mode = 0;
+
+    if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+    {
+        va_list args;
+        va_start(args, flags);
+        mode = mode_t(va_arg(args, int));
+        va_end(args);
+    }
+
+    return resolveNext(realOpen, "open")(path, flags, mode);
+}
+
+ssize_t read(int fd, void* buffer, size_t count)
+{
+    if (inRealtimeRegion())
+        reportViolation("read");
+
+    return resolveNext(realRead, "read")(fd, buffer, count);
+}
+
+ssize_t write(int fd, const void* buffer, size_t count)
+{
+    if (inRealtimeRegion())
+        reportViolation("write");
+
+    return resolveNext(realWrite, "write")(fd, buffer, count);
+}
+
+int poll(struct pollfd* fds, nfds_t numFds, int timeout)
+{
+    if (inRealtimeRegion())
+        reportViolation("poll");
+
+    return resolveNext(realPoll, "poll")(fds, numFds, timeout);
+}
+
+int fsync(int fd)
+{
+    if (inRealtimeRegion())
+        reportViolation("fsync");
+
+    return resolveNext(realFsync, "fsync")(fd);
+}
+
+int usleep(useconds_t micros)
+{
+    if (inRealtimeRegion())
+        reportViolation("usleep");
+
+    return resolveNext(realUsleep, "usleep")(micros);
+}
+
+int nanosleep(const struct timespec* duration, struct timespec* remaining)
+{
+    if (inRealtimeRegion())
+        reportViolation("nanosleep");
+
+    return resolveNext(realNanosleep, "nanosleep")(duration, remaining);
+}
+
+}
+#elif defined(_WIN32)
+static void* rawMalloc(size_t size)                             { return std::malloc(size); }
+static void* rawAlignedMalloc(size_t size, size_t alignment)    { return _aligned_malloc(size, alignment); }
+static void rawFree(void* ptr)                                  { std::free(ptr); }
+static void rawAlignedFree(void* ptr)                           { _aligned_free(ptr); }
+#else
+static void* rawMalloc(size_t size)                             { return std::malloc(size); }
+static void rawFree(void* ptr)                                  { std::free(ptr); }
+static void rawAlignedFree(void* ptr)                           { std::free(ptr); }
+
+static void* rawAlignedMalloc(size_t size, size_t alignment)
+{
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : nullptr;
+}
+#endif
+
+//==============================================================================
+void* operator new(std::size_t size)
+{
+    if (inRealtimeRegion())
+        reportViolation("operator new");
+
+    if (void* ptr = rawMalloc(size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    if (inRealtimeRegion())
+        reportViolation("operator new");
+
+    return rawMalloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr && inRealtimeRegion())
+        reportViolation("operator delete");
+
+    rawFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept                          { operator delete(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept               { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept             { operator delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept     { operator delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept   { operator delete(ptr); }
+
+// the over-aligned overloads, for types with alignas above the default
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (inRealtimeRegion())
+        reportViolation("operator new");
+
+    if (void* ptr = rawAlignedMalloc(size == 0 ? 1 : size, std::size_t(alignment)))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    if (inRealtimeRegion())
+        reportViolation("operator new");
+
+    return rawAlignedMalloc(size == 0 ? 1 : size, std::size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    if (ptr != nullptr && inRealtimeRegion())
+        reportViolation("operator delete");
+
+    rawAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept                  { operator delete(ptr, alignment); }
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept       { operator delete(ptr, alignment); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept     { operator delete(ptr, alignment); }
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept    { operator delete(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept  { operator delete(ptr, alignment); }
+
+#endif
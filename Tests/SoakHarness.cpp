@@ -0,0 +1,431 @@
+/*
+  ==============================================================================
+
+    SoakHarness.cpp
+    Created: 21 Oct 2026 9:37:04am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#include "SoakHarness.h"
+#include "EngineHarness.h"
+#include "../Source/RealtimeCheck.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if JUCE_LINUX
+ #include <cerrno>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <time.h>
+#endif
+
+#define SOAK_NOISE_BLOCKS   64      // distinct input blocks cycled through
+#define SOAK_NUM_PRESETS    8
+
+using SoakClock = std::chrono::steady_clock;
+
+// Written by the audio thread and read by the thread that writes the
+// report while the run goes on, hence the relaxed atomics throughout.
+struct SoakState
+{
+    SoakState()
+    {
+        for (auto& bin : histogram)
+            bin.store(0);
+    }
+
+    std::atomic<bool> running {true};
+    std::atomic<bool> realtime {false};
+
+    std::atomic<juce::uint32> parameterChanges {0};
+    std::atomic<juce::uint32> presetLoads {0};
+
+    std::atomic<juce::int64> histogram[SOAK_HISTOGRAM_BINS];
+    std::atomic<juce::int64> numBlocks {0}, deadlineMisses {0};
+    std::atomic<juce::int64> parameterBlocks {0}, parameterMisses {0};
+    std::atomic<juce::int64> presetBlocks {0}, presetMisses {0};
+    std::atomic<float> maxMicros {0};
+
+    // filled in order; numMisses is published after each entry is complete
+    SoakMiss misses[SOAK_MAX_MISSES];
+    std::atomic<int> numMisses {0};
+};
+
+static int getBin(float micros)
+{
+    if (micros <= 1.f)
+        return 0;
+
+    return juce::jmin(int(std::log2(micros) * 32.f), SOAK_HISTOGRAM_BINS - 1);
+}
+
+static float getBinTop(int bin)
+{
+    return std::exp2(float(bin + 1) / 32.f);
+}
+
+static SoakClock::duration toClock(double seconds)
+{
+    return std::chrono::duration_cast<SoakClock::duration>(std::chrono::duration<double>(seconds));
+}
+
+static void sleepUntil(SoakClock::time_point time)
+{
+#if JUCE_LINUX
+    // steady_clock is CLOCK_MONOTONIC; an absolute wake-up does not drift
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+
+    timespec ts;
+    ts.tv_sec = time_t(ns / 1000000000);
+    ts.tv_nsec = long(ns % 1000000000);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+    std::this_thread::sleep_until(time);
+#endif
+}
+
+//==============================================================================
+static void runAudioThread(ThesisAudioProcessor& processor, const SoakConfig& config,
+                           SoakState& state, SoakClock::time_point startTime)
+{
+#if JUCE_LINUX
+    sched_param param {};
+    param.sched_priority = config.priority;
+    state.realtime = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+
+    const auto period = toClock(config.blockSize / config.sampleRate);
+
+    // the input is made up front so only processBlock is on the clock
+    juce::AudioBuffer<float> noise(2, config.blockSize * SOAK_NOISE_BLOCKS);
+    juce::AudioBuffer<float> buffer(2, config.blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(config.seed);
+
+    for (int chan = 0; chan < 2; chan++)
+        for (int i = 0; i < noise.getNumSamples(); i++)
+            noise.setSample(chan, i, random.nextFloat() - 0.5f);
+
+    juce::uint32 lastParameters = state.parameterChanges.load();
+    juce::uint32 lastPresets = state.presetLoads.load();
+    int parameterCountdown = 0, presetCountdown = 0;
+    int noiseBlock = 0;
+
+    auto next = SoakClock::now();
+
+    while (state.running.load(std::memory_order_relaxed))
+    {
+        // the simulated device hands the block over at next and wants it
+        // back one period later
+        sleepUntil(next);
+        auto deadline = next + period;
+
+        int offset = (noiseBlock++ % SOAK_NOISE_BLOCKS) * config.blockSize;
+        for (int chan = 0; chan < 2; chan++)
+            buffer.copyFrom(chan, 0, noise, chan, offset, config.blockSize);
+
+        // whatever the control thread did since the last block lands in this one
+        auto parameters = state.parameterChanges.load(std::memory_order_relaxed);
+        auto presets = state.presetLoads.load(std::memory_order_relaxed);
+
+        if (parameters != lastParameters)
+            parameterCountdown = SOAK_EVENT_WINDOW;
+        if (presets != lastPresets)
+            presetCountdown = SOAK_EVENT_WINDOW;
+
+        lastParameters = parameters;
+        lastPresets = presets;
+
+        auto start = SoakClock::now();
+        processBlockAsHost(processor, buffer, midi);
+        auto end = SoakClock::now();
+
+        float micros = float(std::chrono::duration<double, std::micro>(end - start).count());
+        bool missed = end > deadline;
+
+        state.histogram[getBin(micros)].fetch_add(1, std::memory_order_relaxed);
+        state.numBlocks.fetch_add(1, std::memory_order_relaxed);
+
+        if (micros > state.maxMicros.load(std::memory_order_relaxed))
+            state.maxMicros.store(micros, std::memory_order_relaxed);
+
+        if (parameterCountdown > 0)
+        {
+            state.parameterBlocks.fetch_add(1, std::memory_order_relaxed);
+            if (missed)
+                state.parameterMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (presetCountdown > 0)
+        {
+            state.presetBlocks.fetch_add(1, std::memory_order_relaxed);
+            if (missed)
+                state.presetMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (missed)
+        {
+            state.deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+
+            int numMisses = state.numMisses.load(std::memory_order_relaxed);
+            if (numMisses < SOAK_MAX_MISSES)
+            {
+                SoakMiss& miss = state.misses[numMisses];
+                miss.time = std::chrono::duration<double>(start - startTime).count();
+                miss.micros = micros;
+                miss.nearParameterChange = parameterCountdown > 0;
+                miss.nearPresetLoad = presetCountdown > 0;
+
+                state.numMisses.store(numMisses + 1, std::memory_order_release);
+            }
+
+            // after an overrun a device carries on from now rather than
+            // queueing up the blocks it lost
+            next = end;
+        }
+        else
+        {
+            next = deadline;
+        }
+
+        parameterCountdown = juce::jmax(0, parameterCountdown - 1);
+        presetCountdown = juce::jmax(0, presetCountdown - 1);
+    }
+}
+
+// Plays the host's message thread: random parameter changes with
+// exponential gaps (so they sometimes bunch up, as automation does) and a
+// preset load every presetInterval.
+static void runControlThread(ThesisAudioProcessor& processor, const SoakConfig& config,
+                             SoakState& state, const std::vector<juce::MemoryBlock>& presets)
+{
+    juce::Random random(config.seed + 1);
+    const auto& parameters = processor.getParameters();
+
+    auto nextGap = [&]
+    {
+        return toClock(-std::log(1.0 - random.nextDouble()) / config.automationRate);
+    };
+
+    auto now = SoakClock::now();
+    auto nextChange = config.automationRate > 0 ? now + nextGap() : SoakClock::time_point::max();
+    auto nextPreset = config.presetInterval > 0 ? now + toClock(config.presetInterval) : SoakClock::time_point::max();
+
+    while (state.running.load(std::memory_order_relaxed))
+    {
+        // wake at least every 100 ms so the run stops promptly
+        std::this_thread::sleep_until(std::min({ nextChange, nextPreset, now + toClock(0.1) }));
+        now = SoakClock::now();
+
+        if (now >= nextChange)
+        {
+            auto* param = parameters[random.nextInt(parameters.size())];
+            param->setValueNotifyingHost(random.nextFloat());
+
+            state.parameterChanges.fetch_add(1, std::memory_order_relaxed);
+            nextChange = now + nextGap();
+        }
+
+        if (now >= nextPreset)
+        {
+            const auto& preset = presets[size_t(random.nextInt(int(presets.size())))];
+            processor.setStateInformation(preset.getData(), int(preset.getSize()));
+
+            state.presetLoads.fetch_add(1, std::memory_order_relaxed);
+            nextPreset += toClock(config.presetInterval);
+        }
+    }
+}
+
+static std::vector<juce::MemoryBlock> makePresets(ThesisAudioProcessor& processor, juce::int64 seed)
+{
+    std::vector<juce::MemoryBlock> presets(SOAK_NUM_PRESETS);
+    juce::Random random(seed + 2);
+
+    juce::MemoryBlock initial;
+    processor.getStateInformation(initial);
+
+    presets[0] = initial;
+
+    for (size_t i = 1; i < presets.size(); i++)
+    {
+        for (auto* param : processor.getParameters())
+            param->setValueNotifyingHost(random.nextFloat());
+
+        processor.getStateInformation(presets[i]);
+    }
+
+    processor.setStateInformation(initial.getData(), int(initial.getSize()));
+
+    return presets;
+}
+
+static float getPercentile(const std::vector<juce::int64>& histogram, juce::int64 total, double fraction)
+{
+    if (total == 0)
+        return 0;
+
+    auto target = juce::int64(std::ceil(fraction * double(total)));
+    juce::int64 count = 0;
+
+    for (int bin = 0; bin < SOAK_HISTOGRAM_BINS; bin++)
+    {
+        count += histogram[size_t(bin)];
+        if (count >= target)
+            return getBinTop(bin);
+    }
+
+    return getBinTop(SOAK_HISTOGRAM_BINS - 1);
+}
+
+static SoakReport makeReport(const SoakConfig& config, const SoakState& state, double elapsed)
+{
+    SoakReport report;
+
+    report.config = config;
+    report.realtime = state.realtime;
+    report.elapsed = elapsed;
+    report.deadlineMicros = config.blockSize / config.sampleRate * 1.0e6;
+
+    report.histogram.resize(SOAK_HISTOGRAM_BINS);
+    for (int bin = 0; bin < SOAK_HISTOGRAM_BINS; bin++)
+        report.histogram[size_t(bin)] = state.histogram[bin].load(std::memory_order_relaxed);
+
+    report.numBlocks = state.numBlocks.load(std::memory_order_relaxed);
+    report.deadlineMisses = state.deadlineMisses.load(std::memory_order_relaxed);
+    report.maxMicros = state.maxMicros.load(std::memory_order_relaxed);
+
+    report.p50 = getPercentile(report.histogram, report.numBlocks, 0.5);
+    report.p99 = getPercentile(report.histogram, report.numBlocks, 0.99);
+    report.p999 = getPercentile(report.histogram, report.numBlocks, 0.999);
+
+    report.numParameterChanges = state.parameterChanges.load(std::memory_order_relaxed);
+    report.numPresetLoads = state.presetLoads.load(std::memory_order_relaxed);
+    report.parameterBlocks = state.parameterBlocks.load(std::memory_order_relaxed);
+    report.parameterMisses = state.parameterMisses.load(std::memory_order_relaxed);
+    report.presetBlocks = state.presetBlocks.load(std::memory_order_relaxed);
+    report.presetMisses = state.presetMisses.load(std::memory_order_relaxed);
+
+    report.violations = getRealtimeViolationCount();
+
+    int numMisses = state.numMisses.load(std::memory_order_acquire);
+    report.misses.assign(state.misses, state.misses + numMisses);
+
+    return report;
+}
+
+static void writeReport(const SoakReport& report, const juce::File& reportFile)
+{
+    if (reportFile != juce::File())
+        reportFile.replaceWithText(describeSoakReport(report));
+}
+
+//==============================================================================
+SoakReport runSoakTest(const SoakConfig& config, const juce::File& reportFile)
+{
+    ThesisAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+    processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+    auto presets = makePresets(processor, config.seed);
+    auto state = std::make_unique<SoakState>();
+
+    resetRealtimeViolations();
+
+    auto startTime = SoakClock::now();
+    auto endTime = startTime + toClock(config.seconds);
+    auto elapsed = [&startTime] { return std::chrono::duration<double>(SoakClock::now() - startTime).count(); };
+
+    std::thread audioThread([&] { runAudioThread(processor, config, *state, startTime); });
+    std::thread controlThread([&] { runControlThread(processor, config, *state, presets); });
+
+    auto nextReport = config.reportInterval > 0 ? startTime + toClock(config.reportInterval) : SoakClock::time_point::max();
+
+    while (SoakClock::now() < endTime)
+    {
+        // what the processor posts to the message thread is handled here;
+        // wake at least every 100 ms for the next report
+        auto wait = std::chrono::duration<double, std::milli>(std::min(endTime, nextReport) - SoakClock::now());
+        dispatchPendingMessages(juce::jlimit(1, 100, int(std::ceil(wait.count()))));
+
+        if (SoakClock::now() >= nextReport && SoakClock::now() < endTime)
+        {
+            writeReport(makeReport(config, *state, elapsed()), reportFile);
+            nextReport += toClock(config.reportInterval);
+        }
+    }
+
+    state->running = false;
+    controlThread.join();
+    audioThread.join();
+
+    processor.releaseResources();
+
+    auto report = makeReport(config, *state, elapsed());
+    writeReport(report, reportFile);
+
+    return report;
+}
+
+static juce::String describeRate(juce::int64 misses, juce::int64 blocks)
+{
+    if (blocks == 0)
+        return "-";
+
+    return juce::String(double(misses) * 1.0e6 / double(blocks), 1) + " per million";
+}
+
+juce::String describeSoakReport(const SoakReport& report)
+{
+    const auto& config = report.config;
+    juce::String text;
+
+    text << "Thesis soak report\n"
+         << "sample rate " << config.sampleRate << " Hz, block " << config.blockSize
+         << ", deadline " << juce::String(report.deadlineMicros, 1) << " us\n"
+         << "ran " << juce::String(report.elapsed, 1) << " of " << juce::String(config.seconds, 1) << " s, "
+         << (report.realtime ? "SCHED_FIFO priority " + juce::String(config.priority) : juce::String("normal priority")) << "\n"
+         << "automation " << config.automationRate << " changes/s, preset every " << config.presetInterval << " s\n"
+         << "\n"
+         << "blocks " << report.numBlocks << ", deadline misses " << report.deadlineMisses
+         << " (" << describeRate(report.deadlineMisses, report.numBlocks) << ")\n"
+         << "block time us: p50 " << juce::String(report.p50, 1)
+         << ", p99 " << juce::String(report.p99, 1)
+         << ", p99.9 " << juce::String(report.p999, 1)
+         << ", max " << juce::String(report.maxMicros, 1) << "\n"
+         << "\n"
+         << "parameter changes " << report.numParameterChanges
+         << ", blocks near one " << report.parameterBlocks
+         << ", misses there " << report.parameterMisses
+         << " (" << describeRate(report.parameterMisses, report.parameterBlocks) << ")\n"
+         << "preset loads " << report.numPresetLoads
+         << ", blocks near one " << report.presetBlocks
+         << ", misses there " << report.presetMisses
+         << " (" << describeRate(report.presetMisses, report.presetBlocks) << ")\n"
+         << "realtime violations " << report.violations
+         << (THESIS_RT_CHECK ? "" : " (not checked; build with THESIS_RT_CHECK)") << "\n";
+
+    text << "\nmisses (first " << SOAK_MAX_MISSES << "): seconds, block us, near\n";
+    for (const auto& miss : report.misses)
+    {
+        text << juce::String(miss.time, 3) << "  " << juce::String(miss.micros, 1)
+             << (miss.nearParameterChange ? "  parameter" : "")
+             << (miss.nearPresetLoad ? "  preset" : "") << "\n";
+    }
+
+    text << "\nhistogram: block us (bin top), count\n";
+    for (int bin = 0; bin < int(report.histogram.size()); bin++)
+    {
+        if (report.histogram[size_t(bin)] > 0)
+            text << juce::String(getBinTop(bin), 1) << "  " << report.histogram[size_t(bin)] << "\n";
+    }
+
+    return text;
+}
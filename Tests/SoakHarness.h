@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SoakHarness.h
+    Created: 21 Oct 2026 9:37:04am
+    Author:  Kevin Kopczynski
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+/*
+    Realtime soak harness: runs a ThesisAudioProcessor on its own thread,
+    woken by a simulated audio clock instead of a device, while a control
+    thread automates random parameters and loads presets the way a host's
+    message thread would. Every block is timed against its deadline (one
+    block period after the clock handed it over), so what this measures is
+    the thing that fails in production: missed callbacks, not average CPU.
+
+    On Linux the audio thread asks for SCHED_FIFO and sleeps on
+    CLOCK_MONOTONIC with absolute deadlines; without the rights for
+    SCHED_FIFO (RLIMIT_RTPRIO or CAP_SYS_NICE) it runs at normal priority
+    and the report says so. Elsewhere it always runs at normal priority.
+
+    The run keeps fixed-size state only, so it can go on for hours: a
+    log-spaced histogram of block times, the first SOAK_MAX_MISSES misses
+    with what happened just before them, and per-cause miss counts. The
+    report file is rewritten every reportInterval seconds, so an aborted
+    run still leaves its numbers behind.
+*/
+
+#define SOAK_HISTOGRAM_BINS     640     // 32 per octave from 1 us, up to ~1 s
+#define SOAK_MAX_MISSES         4096
+#define SOAK_EVENT_WINDOW       4       // blocks after a change that count as near it
+
+struct SoakConfig
+{
+    double sampleRate {48000.0};
+    int blockSize {256};
+    double seconds {3600.0};
+    double automationRate {50.0};       // random parameter changes per second
+    double presetInterval {2.0};        // seconds between preset loads
+    int priority {80};                  // SCHED_FIFO priority of the audio thread
+    double reportInterval {60.0};
+    juce::int64 seed {0x50a4};
+};
+
+struct SoakMiss
+{
+    double time {0};                    // seconds into the run
+    float micros {0};                   // how long processBlock took
+    bool nearParameterChange {false};
+    bool nearPresetLoad {false};
+};
+
+struct SoakReport
+{
+    SoakConfig config;
+    bool realtime {false};              // SCHED_FIFO was granted
+    double elapsed {0};
+    double deadlineMicros {0};
+
+    juce::int64 numBlocks {0};
+    juce::int64 deadlineMisses {0};
+    float p50 {0}, p99 {0}, p999 {0}, maxMicros {0};
+
+    // blocks within SOAK_EVENT_WINDOW of a parameter change or preset
+    // load, and how many of those missed; compare with the overall rate
+    juce::int64 numParameterChanges {0}, numPresetLoads {0};
+    juce::int64 parameterBlocks {0}, parameterMisses {0};
+    juce::int64 presetBlocks {0}, presetMisses {0};
+
+    int violations {0};                 // see RealtimeCheck.h
+    std::vector<SoakMiss> misses;
+    std::vector<juce::int64> histogram;
+};
+
+// Blocks the calling thread for config.seconds, running its message loop
+// if it is the message thread (see dispatchPendingMessages), so what the
+// processor and its parameters post there happens during the run;
+// reportFile may be juce::File() to skip writing.
+SoakReport runSoakTest(const SoakConfig& config, const juce::File& reportFile);
+
+juce::String describeSoakReport(const SoakReport& report);